@@ -0,0 +1,62 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Exponentially growing delay between a lower and an upper bound. Every
+     * call to next() multiplies the delay until the upper bound is reached,
+     * reset() returns to the lower bound. The returned delays are randomly
+     * spread by the jitter factor so multiple clients don't synchronize,
+     * without ever leaving the bounds.
+     */
+    class ExponentialBackoff final {
+        std::chrono::milliseconds _min_delay;
+        std::chrono::milliseconds _max_delay;
+        std::chrono::milliseconds _delay;
+        kstd::f32 _multiplier;
+        kstd::f32 _jitter;
+        std::minstd_rand _random;
+
+        public:
+
+        ExponentialBackoff(std::chrono::milliseconds min_delay, std::chrono::milliseconds max_delay, kstd::f32 multiplier = 2.0F, kstd::f32 jitter = 0.2F) noexcept:
+                _min_delay(min_delay),
+                _max_delay(std::max(min_delay, max_delay)),
+                _delay(min_delay),
+                _multiplier(std::max(multiplier, 1.0F)),
+                _jitter(std::clamp(jitter, 0.0F, 1.0F)),
+                _random(std::random_device()()) {
+        }
+
+        inline auto reset() noexcept -> void {
+            _delay = _min_delay;
+        }
+
+        /**
+         * @return The current delay with jitter applied, never beyond the bounds. The delay grows afterwards.
+         */
+        [[nodiscard]] inline auto next() noexcept -> std::chrono::milliseconds {
+            std::uniform_real_distribution<kstd::f32> distribution(1.0F - _jitter, 1.0F + _jitter);
+            const auto delay = std::chrono::milliseconds(static_cast<kstd::i64>(static_cast<kstd::f32>(_delay.count()) * distribution(_random)));
+            _delay = std::min(std::chrono::milliseconds(static_cast<kstd::i64>(static_cast<kstd::f32>(_delay.count()) * _multiplier)), _max_delay);
+            return std::clamp(delay, std::max(_min_delay, std::chrono::milliseconds(1)), std::max(_max_delay, std::chrono::milliseconds(1)));
+        }
+
+        [[nodiscard]] inline auto get_delay() const noexcept -> std::chrono::milliseconds {
+            return _delay;
+        }
+
+        [[nodiscard]] inline auto is_at_limit() const noexcept -> bool {
+            return _delay >= _max_delay;
+        }
+    };
+}
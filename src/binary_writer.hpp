@@ -0,0 +1,328 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <concepts>
+#include <type_traits>
+#include <kstd/types.hpp>
+#include "json_writer.hpp"
+#include "wire_format.hpp"
+
+namespace fox {
+    /**
+     * Streaming CBOR or MessagePack encoder with the same interface as JsonWriter.
+     * Both formats prefix maps and arrays with their number of members, so a one
+     * byte header is reserved when a container is opened and patched when it is
+     * closed. Containers with more members than fit into that byte grow their
+     * header in place, the output always uses the shortest encoding.
+     */
+    class BinaryWriter final {
+        static constexpr kstd::usize MAX_DEPTH = 8;
+
+        struct Container final {
+            kstd::usize offset;     // Position of the reserved header byte
+            kstd::usize num_members;
+            bool is_map;
+        };
+
+        using Header = std::array<char, 9>;
+
+        std::string& _buffer;
+        WireFormat _format;
+        std::array<Container, MAX_DEPTH> _containers;
+        kstd::usize _depth;
+        bool _is_after_key;
+
+        inline auto separate() noexcept -> void {
+            if (_is_after_key) {
+                _is_after_key = false;
+                return;
+            }
+
+            if (_depth != 0) {
+                ++_containers[_depth - 1].num_members;
+            }
+        }
+
+        /**
+         * Writes a big endian integer of the given width.
+         */
+        static inline auto put_be(Header& header, kstd::usize& size, kstd::u64 value, kstd::usize width) noexcept -> void {
+            for (auto index = width; index > 0; --index) {
+                header[size++] = static_cast<char>((value >> ((index - 1) * 8)) & 0xFF);
+            }
+        }
+
+        /**
+         * @return The size of the CBOR head with the given major type and argument.
+         */
+        static inline auto encode_cbor_head(Header& header, kstd::u8 major, kstd::u64 argument) noexcept -> kstd::usize {
+            kstd::usize size = 1;
+            const auto type = static_cast<kstd::u8>(major << 5);
+
+            if (argument < 24) {
+                header[0] = static_cast<char>(type | argument);
+            }
+            else if (argument <= 0xFF) {
+                header[0] = static_cast<char>(type | 24);
+                put_be(header, size, argument, 1);
+            }
+            else if (argument <= 0xFFFF) {
+                header[0] = static_cast<char>(type | 25);
+                put_be(header, size, argument, 2);
+            }
+            else if (argument <= 0xFFFFFFFF) {
+                header[0] = static_cast<char>(type | 26);
+                put_be(header, size, argument, 4);
+            }
+            else {
+                header[0] = static_cast<char>(type | 27);
+                put_be(header, size, argument, 8);
+            }
+
+            return size;
+        }
+
+        /**
+         * @return The size of the MessagePack map or array header for the given number of members.
+         */
+        static inline auto encode_msgpack_container(Header& header, bool is_map, kstd::usize num_members) noexcept -> kstd::usize {
+            kstd::usize size = 1;
+
+            if (num_members < 16) {
+                header[0] = static_cast<char>((is_map ? 0x80 : 0x90) | num_members);
+            }
+            else if (num_members <= 0xFFFF) {
+                header[0] = static_cast<char>(is_map ? 0xDE : 0xDC);
+                put_be(header, size, num_members, 2);
+            }
+            else {
+                header[0] = static_cast<char>(is_map ? 0xDF : 0xDD);
+                put_be(header, size, num_members, 4);
+            }
+
+            return size;
+        }
+
+        inline auto open(bool is_map) noexcept -> BinaryWriter& {
+            separate();
+            _containers[_depth++] = {_buffer.size(), 0, is_map};
+            _buffer.push_back('\0');
+            return *this;
+        }
+
+        inline auto close() noexcept -> BinaryWriter& {
+            const auto& container = _containers[--_depth];
+            Header header{};
+            const auto size = _format == WireFormat::CBOR
+                ? encode_cbor_head(header, container.is_map ? 5 : 4, container.num_members)
+                : encode_msgpack_container(header, container.is_map, container.num_members);
+            _buffer.replace(container.offset, 1, header.data(), size);
+            return *this;
+        }
+
+        inline auto write_unsigned(kstd::u64 value) noexcept -> void {
+            Header header{};
+            kstd::usize size = 1;
+
+            if (_format == WireFormat::CBOR) {
+                size = encode_cbor_head(header, 0, value);
+            }
+            else if (value <= 0x7F) {
+                header[0] = static_cast<char>(value);
+            }
+            else if (value <= 0xFF) {
+                header[0] = static_cast<char>(0xCC);
+                put_be(header, size, value, 1);
+            }
+            else if (value <= 0xFFFF) {
+                header[0] = static_cast<char>(0xCD);
+                put_be(header, size, value, 2);
+            }
+            else if (value <= 0xFFFFFFFF) {
+                header[0] = static_cast<char>(0xCE);
+                put_be(header, size, value, 4);
+            }
+            else {
+                header[0] = static_cast<char>(0xCF);
+                put_be(header, size, value, 8);
+            }
+
+            _buffer.append(header.data(), size);
+        }
+
+        inline auto write_negative(kstd::i64 value) noexcept -> void {
+            Header header{};
+            kstd::usize size = 1;
+
+            if (_format == WireFormat::CBOR) {
+                size = encode_cbor_head(header, 1, static_cast<kstd::u64>(-(value + 1)));
+            }
+            else if (value >= -32) {
+                header[0] = static_cast<char>(value);
+            }
+            else if (value >= -128) {
+                header[0] = static_cast<char>(0xD0);
+                put_be(header, size, static_cast<kstd::u64>(value), 1);
+            }
+            else if (value >= -32768) {
+                header[0] = static_cast<char>(0xD1);
+                put_be(header, size, static_cast<kstd::u64>(value), 2);
+            }
+            else if (value >= -2147483648LL) {
+                header[0] = static_cast<char>(0xD2);
+                put_be(header, size, static_cast<kstd::u64>(value), 4);
+            }
+            else {
+                header[0] = static_cast<char>(0xD3);
+                put_be(header, size, static_cast<kstd::u64>(value), 8);
+            }
+
+            _buffer.append(header.data(), size);
+        }
+
+        inline auto write_string(std::string_view value) noexcept -> void {
+            Header header{};
+            kstd::usize size = 1;
+
+            if (_format == WireFormat::CBOR) {
+                size = encode_cbor_head(header, 3, value.size());
+            }
+            else if (value.size() < 32) {
+                header[0] = static_cast<char>(0xA0 | value.size());
+            }
+            else if (value.size() <= 0xFF) {
+                header[0] = static_cast<char>(0xD9);
+                put_be(header, size, value.size(), 1);
+            }
+            else if (value.size() <= 0xFFFF) {
+                header[0] = static_cast<char>(0xDA);
+                put_be(header, size, value.size(), 2);
+            }
+            else {
+                header[0] = static_cast<char>(0xDB);
+                put_be(header, size, value.size(), 4);
+            }
+
+            _buffer.append(header.data(), size);
+            _buffer.append(value);
+        }
+
+        public:
+
+        /**
+         * @param buffer The buffer to write to, it is cleared but keeps its capacity.
+         * @param format CBOR or MessagePack.
+         */
+        BinaryWriter(std::string& buffer, WireFormat format) noexcept:
+                _buffer(buffer),
+                _format(format),
+                _containers(),
+                _depth(0),
+                _is_after_key(false) {
+            _buffer.clear();
+        }
+
+        inline auto begin_object() noexcept -> BinaryWriter& {
+            return open(true);
+        }
+
+        inline auto end_object() noexcept -> BinaryWriter& {
+            return close();
+        }
+
+        inline auto begin_array() noexcept -> BinaryWriter& {
+            return open(false);
+        }
+
+        inline auto end_array() noexcept -> BinaryWriter& {
+            return close();
+        }
+
+        inline auto key(std::string_view name) noexcept -> BinaryWriter& {
+            separate();
+            write_string(name);
+            _is_after_key = true;
+            return *this;
+        }
+
+        inline auto value(std::string_view value) noexcept -> BinaryWriter& {
+            separate();
+            write_string(value);
+            return *this;
+        }
+
+        inline auto value(const char* value) noexcept -> BinaryWriter& {
+            return this->value(std::string_view(value));
+        }
+
+        inline auto value(bool value) noexcept -> BinaryWriter& {
+            separate();
+
+            if (_format == WireFormat::CBOR) {
+                _buffer.push_back(static_cast<char>(value ? 0xF5 : 0xF4));
+            }
+            else {
+                _buffer.push_back(static_cast<char>(value ? 0xC3 : 0xC2));
+            }
+
+            return *this;
+        }
+
+        template<typename T>
+        requires(std::integral<T> && !std::same_as<T, bool>)
+        inline auto value(T value) noexcept -> BinaryWriter& {
+            separate();
+
+            if constexpr (std::is_signed_v<T>) {
+                if (value < 0) {
+                    write_negative(value);
+                    return *this;
+                }
+            }
+
+            write_unsigned(static_cast<kstd::u64>(value));
+            return *this;
+        }
+
+        // Enums are written as their underlying value, like nlohmann::json does
+        template<typename T>
+        requires(std::is_enum_v<T>)
+        inline auto value(T value) noexcept -> BinaryWriter& {
+            return this->value(static_cast<std::underlying_type_t<T>>(value));
+        }
+
+        template<typename T>
+        inline auto field(std::string_view name, T value) noexcept -> BinaryWriter& {
+            return key(name).value(value);
+        }
+
+        [[nodiscard]] inline auto get_view() const noexcept -> std::string_view {
+            return _buffer;
+        }
+    };
+
+    /**
+     * Encodes a document in the given format by calling write with either a JsonWriter or a BinaryWriter.
+     * @return A view of the encoded document inside the buffer.
+     */
+    template<typename F>
+    inline auto encode_document(WireFormat format, std::string& buffer, F&& write) noexcept -> std::string_view {
+        if (format == WireFormat::JSON) {
+            JsonWriter writer(buffer);
+            write(writer);
+        }
+        else {
+            BinaryWriter writer(buffer, format);
+            write(writer);
+        }
+
+        return buffer;
+    }
+}
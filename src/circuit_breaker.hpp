@@ -0,0 +1,161 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <kstd/types.hpp>
+#include "backoff.hpp"
+
+namespace fox {
+    enum class CircuitState : kstd::u8 {
+        CLOSED,     // Requests pass through
+        OPEN,       // Requests are rejected until the open time ran out
+        HALF_OPEN   // A single probe request is let through to test for recovery
+    };
+
+    [[nodiscard]] constexpr auto get_circuit_state_name(CircuitState state) noexcept -> const char* {
+        switch (state) {
+            case CircuitState::CLOSED:
+                return "Closed";
+            case CircuitState::OPEN:
+                return "Open";
+            default:
+                return "Half-Open";
+        }
+    }
+
+    struct CircuitBreakerStats final {
+        CircuitState state;
+        kstd::u64 num_successes;
+        kstd::u64 num_failures;
+        kstd::u64 num_rejected;
+        kstd::u64 num_trips;
+    };
+
+    /**
+     * Stops sending requests to an endpoint which keeps failing. After the given
+     * number of consecutive failures the circuit opens and rejects all requests.
+     * Once the open time ran out, one probe request is let through. If it fails,
+     * the circuit opens again for an exponentially longer time, otherwise it closes.
+     * Thread safe, every permitted request has to be followed by exactly one
+     * call to on_success or on_failure.
+     */
+    class CircuitBreaker final {
+        using Clock = std::chrono::steady_clock;
+
+        mutable std::mutex _mutex;
+        kstd::u32 _failure_threshold;
+        ExponentialBackoff _open_time;
+        CircuitState _state;
+        kstd::u32 _num_consecutive_failures;
+        Clock::time_point _closes_at;
+        bool _is_probing;
+        CircuitBreakerStats _stats;
+
+        public:
+
+        CircuitBreaker(kstd::u32 failure_threshold, std::chrono::milliseconds min_open_time, std::chrono::milliseconds max_open_time) noexcept:
+                _mutex(),
+                _failure_threshold(failure_threshold),
+                _open_time(min_open_time, max_open_time),
+                _state(CircuitState::CLOSED),
+                _num_consecutive_failures(0),
+                _closes_at(),
+                _is_probing(false),
+                _stats() {
+        }
+
+        /**
+         * @return True if a request may be sent right now.
+         */
+        [[nodiscard]] inline auto try_acquire() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+
+            switch (_state) {
+                case CircuitState::CLOSED:
+                    return true;
+                case CircuitState::OPEN:
+                    if (Clock::now() < _closes_at) {
+                        ++_stats.num_rejected;
+                        return false;
+                    }
+
+                    _state = CircuitState::HALF_OPEN;
+                    _is_probing = true;
+                    return true;
+                case CircuitState::HALF_OPEN:
+                    if (_is_probing) {
+                        ++_stats.num_rejected;
+                        return false;
+                    }
+
+                    _is_probing = true;
+                    return true;
+            }
+
+            return true;
+        }
+
+        /**
+         * @return True if this success closed a previously open circuit.
+         */
+        inline auto on_success() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            ++_stats.num_successes;
+            _num_consecutive_failures = 0;
+            _is_probing = false;
+
+            if (_state == CircuitState::CLOSED) {
+                return false;
+            }
+
+            _state = CircuitState::CLOSED;
+            _open_time.reset();
+            return true;
+        }
+
+        /**
+         * @return True if this failure opened the circuit.
+         */
+        inline auto on_failure() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            ++_stats.num_failures;
+            _is_probing = false;
+
+            // Requests sent before the circuit opened don't extend the open time
+            if (_state == CircuitState::OPEN || (_state == CircuitState::CLOSED && ++_num_consecutive_failures < _failure_threshold)) {
+                return false;
+            }
+
+            _state = CircuitState::OPEN;
+            _closes_at = Clock::now() + _open_time.next();
+            ++_stats.num_trips;
+            return true;
+        }
+
+        /**
+         * @return The time until the next request may be sent, zero if the circuit is closed.
+         */
+        [[nodiscard]] inline auto get_remaining_open_time() const noexcept -> std::chrono::milliseconds {
+            std::scoped_lock lock(_mutex);
+
+            if (_state != CircuitState::OPEN) {
+                return std::chrono::milliseconds::zero();
+            }
+
+            const auto now = Clock::now();
+            return _closes_at > now ? std::chrono::ceil<std::chrono::milliseconds>(_closes_at - now) : std::chrono::milliseconds::zero();
+        }
+
+        [[nodiscard]] inline auto get_stats() const noexcept -> CircuitBreakerStats {
+            std::scoped_lock lock(_mutex);
+            auto stats = _stats;
+            stats.state = _state;
+            return stats;
+        }
+    };
+}
@@ -0,0 +1,189 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <openssl/ssl.h>
+#include <spdlog/spdlog.h>
+#include "connection.hpp"
+
+namespace fox {
+    TlsSessionCache::TlsSessionCache(SSL_CTX* context, std::string name) noexcept:
+            _context(context),
+            _name(std::move(name)),
+            _session(nullptr),
+            _session_mutex(),
+            _num_handshakes(0),
+            _num_resumed_handshakes(0),
+            _handshake_times(),
+            _handshake_times_mutex() {
+        if (_context == nullptr) {
+            spdlog::warn("TLS session resumption is not available for {}", _name);
+            return;
+        }
+
+        // New sessions are handed to on_new_session instead of the internal cache, which is only consulted by servers
+        SSL_CTX_set_app_data(_context, this);
+        SSL_CTX_set_session_cache_mode(_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(_context, on_new_session);
+        SSL_CTX_set_info_callback(_context, on_info);
+    }
+
+    TlsSessionCache::~TlsSessionCache() noexcept {
+        if (_context != nullptr) {
+            SSL_CTX_set_info_callback(_context, nullptr);
+            SSL_CTX_sess_set_new_cb(_context, nullptr);
+            SSL_CTX_set_app_data(_context, nullptr);
+        }
+
+        drop();
+    }
+
+    auto TlsSessionCache::on_new_session(SSL* ssl, SSL_SESSION* session) noexcept -> int {
+        auto* self = static_cast<TlsSessionCache*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+
+        if (self == nullptr || SSL_SESSION_is_resumable(session) != 1) {
+            return 0;
+        }
+
+        std::scoped_lock lock(self->_session_mutex);
+
+        if (self->_session != nullptr) {
+            SSL_SESSION_free(self->_session);
+        }
+
+        self->_session = session;
+        return 1; // Keeps the reference handed to us
+    }
+
+    auto TlsSessionCache::on_info(const SSL* ssl, int where, [[maybe_unused]] int result) noexcept -> void {
+        auto* self = static_cast<TlsSessionCache*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+
+        if (self == nullptr) {
+            return;
+        }
+
+        // This is the last point before the client hello is constructed, the only one between SSL_new and
+        // SSL_connect which OpenSSL exposes. Once the handshake got any further the session is left alone.
+        if ((where & SSL_CB_HANDSHAKE_START) != 0) {
+            if (SSL_in_before(ssl) != 1 || SSL_get_session(ssl) != nullptr) {
+                return;
+            }
+
+            std::scoped_lock lock(self->_session_mutex);
+
+            if (self->_session != nullptr && SSL_set_session(const_cast<SSL*>(ssl), self->_session) != 1) {
+                spdlog::warn("Could not offer cached TLS session to {}", self->_name);
+            }
+
+            return;
+        }
+
+        if ((where & SSL_CB_HANDSHAKE_DONE) != 0) {
+            self->record_handshake(SSL_session_reused(ssl) == 1);
+        }
+    }
+
+    auto TlsSessionCache::record_handshake(bool is_resumed) noexcept -> void {
+        using namespace std::chrono_literals;
+
+        ++_num_handshakes;
+
+        if (is_resumed) {
+            ++_num_resumed_handshakes;
+        }
+
+        spdlog::debug("Completed {} TLS handshake with {}", is_resumed ? "resumed" : "full", _name);
+
+        const auto now = std::chrono::steady_clock::now();
+        std::scoped_lock lock(_handshake_times_mutex);
+        _handshake_times.push_back(now);
+
+        while (_handshake_times.front() + 1min < now) {
+            _handshake_times.pop_front();
+        }
+    }
+
+    auto TlsSessionCache::drop() noexcept -> void {
+        std::scoped_lock lock(_session_mutex);
+
+        if (_session != nullptr) {
+            SSL_SESSION_free(_session);
+            _session = nullptr;
+        }
+    }
+
+    auto TlsSessionCache::get_handshakes_per_minute() const noexcept -> kstd::u32 {
+        using namespace std::chrono_literals;
+
+        const auto now = std::chrono::steady_clock::now();
+        std::scoped_lock lock(_handshake_times_mutex);
+
+        return static_cast<kstd::u32>(std::count_if(_handshake_times.begin(), _handshake_times.end(), [now](const auto& time) {
+            return time + 1min >= now;
+        }));
+    }
+
+    HttpsConnection::HttpsConnection(const std::string& address, kstd::u32 port, const std::string& certificate_path) noexcept:
+            _client(address, static_cast<int>(port)),
+            _address(address),
+            _sessions(_client.ssl_context(), address),
+            _num_requests(0),
+            _num_failures(0),
+            _num_consecutive_failures(0) {
+        _client.set_ca_cert_path(certificate_path);
+        _client.enable_server_certificate_verification(false);
+        _client.set_default_headers({std::make_pair("Cache-Control", "private,max-age=0")}); // https://developers.cloudflare.com/cache/about/cache-control/
+        _client.set_keep_alive(true);
+        _client.set_tcp_nodelay(true);
+    }
+
+    auto HttpsConnection::record_result(const httplib::Result& result) noexcept -> void {
+        ++_num_requests;
+
+        // HTTP level errors still mean the connection itself is fine
+        if (result) {
+            _num_consecutive_failures = 0;
+            return;
+        }
+
+        ++_num_failures;
+
+        if (++_num_consecutive_failures < MAX_CONSECUTIVE_FAILURES) {
+            return;
+        }
+
+        spdlog::warn("Connection to {} failed {} times in a row ({}), reconnecting with a full handshake", _address, _num_consecutive_failures.load(), httplib::to_string(result.error()));
+        _client.stop();
+        // The server may have rotated its ticket keys, so a stale session would only be rejected again
+        _sessions.drop();
+        _num_consecutive_failures = 0;
+    }
+
+    auto HttpsConnection::post(const std::string& path, const httplib::Headers& headers, std::string_view body, const std::string& content_type) noexcept -> httplib::Result {
+        auto result = _client.Post(path, headers, body.data(), body.size(), content_type);
+        record_result(result);
+        return result;
+    }
+
+    auto HttpsConnection::get(const std::string& path, const httplib::Headers& headers, httplib::ResponseHandler on_response, httplib::ContentReceiver on_content) noexcept -> httplib::Result {
+        auto result = _client.Get(path, headers, std::move(on_response), std::move(on_content));
+        record_result(result);
+        return result;
+    }
+
+    auto HttpsConnection::stop() noexcept -> void {
+        _client.stop();
+    }
+
+    auto HttpsConnection::get_stats() const noexcept -> ConnectionStats {
+        return {
+            _num_requests,
+            _num_failures,
+            _sessions.get_num_handshakes(),
+            _sessions.get_num_resumed_handshakes(),
+            _sessions.get_handshakes_per_minute()
+        };
+    }
+}
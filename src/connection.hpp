@@ -0,0 +1,139 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <httplib.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    constexpr kstd::u32 MAX_CONSECUTIVE_FAILURES = 3;
+
+    struct ConnectionStats final {
+        kstd::u64 num_requests;
+        kstd::u64 num_failures;
+        kstd::u64 num_handshakes;
+        kstd::u64 num_resumed_handshakes;
+        kstd::u32 handshakes_per_minute;
+    };
+
+    /**
+     * Client side TLS session cache for a single SSL context. The context's
+     * new session hook keeps the last session (or TLS 1.3 ticket) the server
+     * handed out, and every later connection of the context offers it before
+     * its client hello is written, so a reconnect can skip the full handshake.
+     * OpenSSL never does the latter by itself, its internal cache only serves
+     * servers. Also counts the handshakes and how many of them were resumed.
+     */
+    class TlsSessionCache final {
+        SSL_CTX* _context;
+        std::string _name;
+        SSL_SESSION* _session;
+        std::mutex _session_mutex;
+        std::atomic_uint64_t _num_handshakes;
+        std::atomic_uint64_t _num_resumed_handshakes;
+        std::deque<std::chrono::steady_clock::time_point> _handshake_times;
+        mutable std::mutex _handshake_times_mutex;
+
+        static auto on_new_session(SSL* ssl, SSL_SESSION* session) noexcept -> int;
+
+        static auto on_info(const SSL* ssl, int where, int result) noexcept -> void;
+
+        auto record_handshake(bool is_resumed) noexcept -> void;
+
+        public:
+
+        /**
+         * @param context The client context to cache sessions for, nothing is cached if it is null.
+         * @param name Names the peer in log messages.
+         */
+        TlsSessionCache(SSL_CTX* context, std::string name) noexcept;
+
+        TlsSessionCache(const TlsSessionCache& other) = delete;
+
+        TlsSessionCache(TlsSessionCache&& other) = delete;
+
+        ~TlsSessionCache() noexcept;
+
+        auto operator =(const TlsSessionCache& other) -> TlsSessionCache& = delete;
+
+        auto operator =(TlsSessionCache&& other) -> TlsSessionCache& = delete;
+
+        /**
+         * Forgets the cached session, so the next handshake is a full one.
+         */
+        auto drop() noexcept -> void;
+
+        [[nodiscard]] auto get_handshakes_per_minute() const noexcept -> kstd::u32;
+
+        [[nodiscard]] inline auto get_num_handshakes() const noexcept -> kstd::u64 {
+            return _num_handshakes;
+        }
+
+        [[nodiscard]] inline auto get_num_resumed_handshakes() const noexcept -> kstd::u64 {
+            return _num_resumed_handshakes;
+        }
+    };
+
+    /**
+     * Persistent HTTPS connection to a single host. Requests reuse the same
+     * keep-alive connection, and whenever it has to be re-established the
+     * cached TLS session is offered to the server. A connection which keeps
+     * failing at the transport level is torn down and the cached session is
+     * dropped, so the next request starts over from a clean slate.
+     */
+    class HttpsConnection final {
+        httplib::SSLClient _client;
+        std::string _address;
+        TlsSessionCache _sessions;
+        std::atomic_uint64_t _num_requests;
+        std::atomic_uint64_t _num_failures;
+        std::atomic_uint32_t _num_consecutive_failures;
+
+        auto record_result(const httplib::Result& result) noexcept -> void;
+
+        public:
+
+        HttpsConnection(const std::string& address, kstd::u32 port, const std::string& certificate_path) noexcept;
+
+        HttpsConnection(const HttpsConnection& other) = delete;
+
+        HttpsConnection(HttpsConnection&& other) = delete;
+
+        ~HttpsConnection() noexcept = default;
+
+        auto operator =(const HttpsConnection& other) -> HttpsConnection& = delete;
+
+        auto operator =(HttpsConnection&& other) -> HttpsConnection& = delete;
+
+        auto post(const std::string& path, const httplib::Headers& headers, std::string_view body, const std::string& content_type) noexcept -> httplib::Result;
+
+        auto get(const std::string& path, const httplib::Headers& headers, httplib::ResponseHandler on_response, httplib::ContentReceiver on_content) noexcept -> httplib::Result;
+
+        /**
+         * Aborts the request in progress, safe to call from any thread.
+         */
+        auto stop() noexcept -> void;
+
+        [[nodiscard]] auto get_stats() const noexcept -> ConnectionStats;
+
+        /**
+         * @return False if the last requests failed before reaching the server.
+         */
+        [[nodiscard]] inline auto is_healthy() const noexcept -> bool {
+            return _num_consecutive_failures == 0;
+        }
+
+        [[nodiscard]] inline auto get_client() noexcept -> httplib::SSLClient& {
+            return _client;
+        }
+    };
+}
@@ -0,0 +1,240 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <openssl/crypto.h>
+#include <spdlog/spdlog.h>
+#include "control_endpoint.hpp"
+#include "binary_writer.hpp"
+#include "json_writer.hpp"
+#include "task_parser.hpp"
+#include "wire_format.hpp"
+#include "reflect.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include "server.hpp"
+
+namespace fox {
+    ControlEndpoint::ControlEndpoint(Server& server, std::string address, kstd::u32 port, std::string password) noexcept:
+            _server(server),
+            _http_server(),
+            _address(std::move(address)),
+            _port(port),
+            _password(std::move(password)),
+            _thread(),
+            _is_running(true),
+            _is_listening(false),
+            _num_subscribers(0) {
+        _http_server.set_tcp_nodelay(true);
+
+        _http_server.Post("/tasks", [this](const httplib::Request& request, httplib::Response& response) {
+            handle_tasks(this, request, response);
+        });
+
+        _http_server.Get("/state", [this](const httplib::Request& request, httplib::Response& response) {
+            handle_state(this, request, response);
+        });
+
+        _http_server.Get("/events", [this](const httplib::Request& request, httplib::Response& response) {
+            handle_events(this, request, response);
+        });
+
+        _http_server.Get("/trace", [this](const httplib::Request& request, httplib::Response& response) {
+            handle_trace(this, request, response);
+        });
+
+        _http_server.Get("/trace/latency", [this](const httplib::Request& request, httplib::Response& response) {
+            handle_trace_latency(this, request, response);
+        });
+
+        // Left open so scrapers don't need the password, metrics reveal nothing which would allow control
+        _http_server.Get("/metrics", handle_metrics);
+
+        // Every client would send the empty password and pass as well
+        if (_password.empty()) {
+            spdlog::error("Refusing to start control endpoint without a password");
+            return;
+        }
+
+        if (!_http_server.bind_to_port(_address, static_cast<int>(_port))) {
+            spdlog::error("Could not bind control endpoint to {}:{}", _address, _port);
+            return;
+        }
+
+        _is_listening = true;
+        _thread = std::thread(listen_loop, this);
+    }
+
+    ControlEndpoint::~ControlEndpoint() noexcept {
+        _is_running = false;
+        _http_server.stop();
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    auto ControlEndpoint::listen_loop(ControlEndpoint* self) noexcept -> void {
+        spdlog::info("Control endpoint listening on {}:{}", self->_address, self->_port);
+
+        if (!self->_http_server.listen_after_bind() && self->_is_running) {
+            spdlog::error("Control endpoint stopped unexpectedly");
+        }
+
+        self->_is_listening = false;
+    }
+
+    auto ControlEndpoint::is_authorized(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> bool {
+        const auto& expected = self->_password;
+        const auto password = request.get_header_value("X-Fox-Password");
+
+        // Compares in constant time, so the response time gives away nothing about how much of the password matched
+        if (!expected.empty() && password.size() == expected.size() && ::CRYPTO_memcmp(password.data(), expected.data(), expected.size()) == 0) {
+            return true;
+        }
+
+        spdlog::warn("Rejected unauthorized control request from {}", request.remote_addr);
+        response.status = 401;
+        return false;
+    }
+
+    auto ControlEndpoint::handle_tasks(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        const auto received_at = TraceClock::now();
+
+        if (!is_authorized(self, request, response)) {
+            return;
+        }
+
+        thread_local TaskListParser parser;
+
+        if (!parser.parse(request.body, get_wire_format_of(request.get_header_value("Content-Type"))) || !parser.has_tasks()) {
+            response.status = 400;
+            response.set_content(parser.get_parse_error().empty() ? "No task list" : parser.get_parse_error(), "text/plain");
+            return;
+        }
+
+        const auto& tasks = parser.get_tasks();
+        const auto num_applied = tasks.empty() ? 0 : self->_server.apply_tasks(tasks, received_at);
+        spdlog::debug("Applied {} of {} local tasks", num_applied, tasks.size());
+
+        // Answers with the accepted tasks and the reasons for rejecting the others
+        const auto format = get_preferred_wire_format(request.get_header_value("Accept"));
+        const auto body = encode_document(format, get_thread_json_buffer(), [&tasks, num_applied](auto& writer) {
+            writer.begin_object();
+            writer.field("num_accepted", tasks.size());
+            writer.field("num_applied", num_applied);
+            writer.key("errors");
+            writer.begin_array();
+
+            for (const auto& [index, reason, field]: parser.get_errors()) {
+                writer.begin_object();
+                writer.field("index", index);
+                writer.field("reason", reason);
+                writer.field("field", field);
+                writer.end_object();
+            }
+
+            writer.end_array();
+            writer.end_object();
+        });
+
+        response.set_content(body.data(), body.size(), get_mime_type(format));
+    }
+
+    auto ControlEndpoint::handle_state(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        if (!is_authorized(self, request, response)) {
+            return;
+        }
+
+        const auto state = self->_server.get_state_snapshot();
+        const auto format = get_preferred_wire_format(request.get_header_value("Accept"));
+        const auto body = encode_document(format, get_thread_json_buffer(), [&state](auto& writer) {
+            write_object(writer, state);
+        });
+
+        response.set_header("Cache-Control", "no-store");
+        response.set_content(body.data(), body.size(), get_mime_type(format));
+    }
+
+    auto ControlEndpoint::handle_events(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        if (!is_authorized(self, request, response)) {
+            return;
+        }
+
+        if (++self->_num_subscribers > MAX_EVENT_SUBSCRIBERS) {
+            --self->_num_subscribers;
+            response.status = 503;
+            return;
+        }
+
+        response.set_header("Cache-Control", "no-store");
+
+        // The first call sends the current state, every further call blocks until the state changes
+        auto version = self->_server.get_state_version();
+        auto is_first = true;
+
+        const auto provider = [self, version, is_first]([[maybe_unused]] size_t offset, httplib::DataSink& sink) mutable {
+            const auto deadline = std::chrono::steady_clock::now() + EVENT_KEEP_ALIVE_INTERVAL;
+            auto current = version;
+
+            while (!is_first && current == version && self->_is_running && std::chrono::steady_clock::now() < deadline) {
+                current = self->_server.wait_for_state_change(version, EVENT_POLL_INTERVAL);
+            }
+
+            if (!self->_is_running) {
+                return false;
+            }
+
+            if (!is_first && current == version) {
+                constexpr std::string_view keep_alive = ": keep-alive\n\n";
+                return sink.write(keep_alive.data(), keep_alive.size());
+            }
+
+            is_first = false;
+            version = current;
+
+            auto& buffer = get_thread_json_buffer();
+            JsonWriter writer(buffer);
+            write_object(writer, self->_server.get_state_snapshot());
+            std::string event;
+            event.reserve(buffer.size() + 24);
+            event.append("event: state\ndata: ").append(buffer).append("\n\n");
+            return sink.write(event.data(), event.size());
+        };
+
+        response.set_chunked_content_provider("text/event-stream", provider, [self](bool) {
+            --self->_num_subscribers;
+        });
+    }
+
+    auto ControlEndpoint::handle_trace(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        if (!is_authorized(self, request, response)) {
+            return;
+        }
+
+        auto& buffer = get_thread_json_buffer();
+        self->_server.get_tracer().write_chrome_trace(buffer);
+        response.set_header("Cache-Control", "no-store");
+        response.set_content(buffer.data(), buffer.size(), "application/json");
+    }
+
+    auto ControlEndpoint::handle_trace_latency(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        if (!is_authorized(self, request, response)) {
+            return;
+        }
+
+        auto& buffer = get_thread_json_buffer();
+        buffer.clear();
+        self->_server.get_tracer().write_latency_report(buffer);
+        response.set_header("Cache-Control", "no-store");
+        response.set_content(buffer.data(), buffer.size(), "text/plain");
+    }
+
+    auto ControlEndpoint::handle_metrics([[maybe_unused]] const httplib::Request& request, httplib::Response& response) noexcept -> void {
+        auto& buffer = get_thread_json_buffer();
+        buffer.clear();
+        write_metrics(buffer);
+        response.set_content(buffer.data(), buffer.size(), "text/plain; version=0.0.4");
+    }
+}
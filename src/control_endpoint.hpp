@@ -0,0 +1,83 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <httplib.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    class Server;
+
+    constexpr std::chrono::milliseconds EVENT_KEEP_ALIVE_INTERVAL(15000);
+    constexpr std::chrono::milliseconds EVENT_POLL_INTERVAL(250); // Bounds how long stopping waits for event streams
+    constexpr kstd::u32 MAX_EVENT_SUBSCRIBERS = 4; // Keeps worker threads free for task requests
+
+    /**
+     * Local HTTP endpoint for driving the device from the LAN without a round
+     * trip through the gateway. Speaks the same task format as /fetch:
+     *
+     * POST /tasks   Task list as JSON, CBOR or MessagePack, applied right away
+     * GET  /state   The current device state, encoded as requested by Accept
+     * GET  /events  Server-sent "state" events whenever the device state changes
+     * GET  /metrics All metrics in the Prometheus text format
+     *
+     * Every request but /metrics has to carry the gateway password in the X-Fox-Password header.
+     * Without a password the endpoint refuses to start.
+     */
+    class ControlEndpoint final {
+        Server& _server;
+        httplib::Server _http_server;
+        std::string _address;
+        kstd::u32 _port;
+        std::string _password;
+        std::thread _thread;
+        std::atomic_bool _is_running;
+        std::atomic_bool _is_listening;
+        std::atomic_uint32_t _num_subscribers;
+
+        static auto is_authorized(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> bool;
+
+        static auto handle_tasks(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto handle_state(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto handle_events(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto handle_trace(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto handle_trace_latency(ControlEndpoint* self, const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto handle_metrics(const httplib::Request& request, httplib::Response& response) noexcept -> void;
+
+        static auto listen_loop(ControlEndpoint* self) noexcept -> void;
+
+        public:
+
+        ControlEndpoint(Server& server, std::string address, kstd::u32 port, std::string password) noexcept;
+
+        ControlEndpoint(const ControlEndpoint& other) = delete;
+
+        ControlEndpoint(ControlEndpoint&& other) = delete;
+
+        ~ControlEndpoint() noexcept;
+
+        auto operator =(const ControlEndpoint& other) -> ControlEndpoint& = delete;
+
+        auto operator =(ControlEndpoint&& other) -> ControlEndpoint& = delete;
+
+        [[nodiscard]] inline auto is_listening() const noexcept -> bool {
+            return _is_listening;
+        }
+
+        [[nodiscard]] inline auto get_num_subscribers() const noexcept -> kstd::u32 {
+            return _num_subscribers;
+        }
+    };
+}
@@ -5,13 +5,14 @@
 
 #pragma once
 
+#include <variant>
 #include <kstd/types.hpp>
-#include <nlohmann/json.hpp>
-
-#define FOX_JSON_SET(j, x) j[#x] = x
-#define FOX_JSON_GET(j, x) x = j[#x]
+#include "reflect.hpp"
 
 namespace fox::dto {
+    constexpr kstd::i32 MIN_SPEED = 0;
+    constexpr kstd::i32 MAX_SPEED = 32;
+
     enum class TaskType : kstd::u8 {
         POWER,
         SPEED,
@@ -23,84 +24,37 @@ namespace fox::dto {
     };
 
     struct PowerTask final {
-        TaskType type;
-        bool is_on;
+        static constexpr TaskType TYPE = TaskType::POWER;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, is_on);
-        }
+        bool is_on;
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, is_on);
-        }
+        static constexpr auto FIELDS = std::make_tuple(field("is_on", &PowerTask::is_on));
     };
 
     struct SpeedTask final {
-        TaskType type;
-        kstd::i32 speed;
+        static constexpr TaskType TYPE = TaskType::SPEED;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, speed);
-        }
+        kstd::i32 speed;
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, speed);
-        }
+        static constexpr auto FIELDS = std::make_tuple(field("speed", &SpeedTask::speed, MIN_SPEED, MAX_SPEED));
     };
 
     struct ModeTask final {
-        TaskType type;
-        Mode mode;
+        static constexpr TaskType TYPE = TaskType::MODE;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, type);
-            FOX_JSON_SET(json, mode);
-        }
+        Mode mode;
 
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, type);
-            FOX_JSON_GET(json, mode);
-        }
+        static constexpr auto FIELDS = std::make_tuple(field("mode", &ModeTask::mode, Mode::DEFAULT));
     };
 
-    union Task {
-        TaskType type;
-        PowerTask power;
-        SpeedTask speed;
-        ModeTask mode;
-
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            switch (type) {
-                case TaskType::POWER:
-                    power.serialize(json);
-                    break;
-                case TaskType::SPEED:
-                    speed.serialize(json);
-                    break;
-                case TaskType::MODE:
-                    mode.serialize(json);
-                    break;
-            }
-        }
-
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            switch (static_cast<TaskType>(json["type"])) {
-                case TaskType::POWER:
-                    power.deserialize(json);
-                    break;
-                case TaskType::SPEED:
-                    speed.deserialize(json);
-                    break;
-                case TaskType::MODE:
-                    mode.deserialize(json);
-                    break;
-            }
-        }
-    };
+    // New task types only need a TYPE, their FIELDS and an entry here
+    using Task = std::variant<PowerTask, SpeedTask, ModeTask>;
+
+    [[nodiscard]] constexpr auto get_task_type(const Task& task) noexcept -> TaskType {
+        return std::visit([](const auto& alternative) {
+            return std::remove_cvref_t<decltype(alternative)>::TYPE;
+        }, task);
+    }
 
     struct DeviceState final {
         bool accepts_commands;
@@ -109,20 +63,12 @@ namespace fox::dto {
         kstd::u32 actual_speed;
         Mode mode;
 
-        inline auto serialize(nlohmann::json& json) noexcept -> void {
-            FOX_JSON_SET(json, accepts_commands);
-            FOX_JSON_SET(json, is_on);
-            FOX_JSON_SET(json, target_speed);
-            FOX_JSON_SET(json, actual_speed);
-            FOX_JSON_SET(json, mode);
-        }
-
-        inline auto deserialize(const nlohmann::json& json) noexcept -> void {
-            FOX_JSON_GET(json, accepts_commands);
-            FOX_JSON_GET(json, is_on);
-            FOX_JSON_GET(json, target_speed);
-            FOX_JSON_GET(json, actual_speed);
-            FOX_JSON_GET(json, mode);
-        }
+        static constexpr auto FIELDS = std::make_tuple(
+            field("accepts_commands", &DeviceState::accepts_commands),
+            field("is_on", &DeviceState::is_on),
+            field("target_speed", &DeviceState::target_speed),
+            field("actual_speed", &DeviceState::actual_speed),
+            field("mode", &DeviceState::mode, Mode::DEFAULT)
+        );
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Incremental parser for text/event-stream (server-sent events) bodies.
+     * Chunks may split lines and events at any position, so incomplete lines
+     * are kept until the rest arrives. Comment lines (used as keep-alives)
+     * and fields other than event, data and id are ignored.
+     *
+     * The id of the last complete event survives a reset, so a client can
+     * send it as Last-Event-ID when reconnecting and the server resumes the
+     * stream right after it.
+     */
+    class EventStreamParser final {
+        std::string _buffer;
+        std::string _event;
+        std::string _data;
+        std::string _event_id;      // Id of the event being received, inherited from the previous one
+        std::string _last_event_id; // Id of the last complete event
+
+        public:
+
+        EventStreamParser() noexcept:
+                _buffer(),
+                _event(),
+                _data(),
+                _event_id(),
+                _last_event_id() {
+        }
+
+        template<typename F>
+        requires(std::is_invocable_v<F, std::string_view, std::string_view>)
+        inline auto feed(std::string_view chunk, F&& on_event) noexcept -> void {
+            _buffer.append(chunk);
+            kstd::usize offset = 0;
+
+            for (auto end = _buffer.find('\n', offset); end != std::string::npos; end = _buffer.find('\n', offset)) {
+                auto line = std::string_view(_buffer).substr(offset, end - offset);
+                offset = end + 1;
+
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+
+                // An empty line terminates the current event
+                if (line.empty()) {
+                    _last_event_id = _event_id;
+
+                    if (!_data.empty()) {
+                        on_event(_event.empty() ? std::string_view("message") : std::string_view(_event), std::string_view(_data));
+                    }
+
+                    _event.clear();
+                    _data.clear();
+                    continue;
+                }
+
+                if (line.front() == ':') {
+                    continue;
+                }
+
+                const auto separator = line.find(':');
+                const auto field = line.substr(0, separator);
+                auto value = separator == std::string_view::npos ? std::string_view() : line.substr(separator + 1);
+
+                if (!value.empty() && value.front() == ' ') {
+                    value.remove_prefix(1);
+                }
+
+                if (field == "event") {
+                    _event = value;
+                }
+                else if (field == "data") {
+                    if (!_data.empty()) {
+                        _data.push_back('\n');
+                    }
+
+                    _data.append(value);
+                }
+                else if (field == "id" && value.find('\0') == std::string_view::npos) {
+                    _event_id = value;
+                }
+            }
+
+            _buffer.erase(0, offset);
+        }
+
+        /**
+         * Drops the event which was being received, for when the connection was lost.
+         */
+        inline auto reset() noexcept -> void {
+            _buffer.clear();
+            _event.clear();
+            _data.clear();
+            _event_id = _last_event_id;
+        }
+
+        /**
+         * @return The id of the last complete event, empty if the server never sent one.
+         */
+        [[nodiscard]] inline auto get_last_event_id() const noexcept -> const std::string& {
+            return _last_event_id;
+        }
+    };
+}
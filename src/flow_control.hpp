@@ -0,0 +1,182 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <limits>
+#include <string_view>
+#include <optional>
+#include <algorithm>
+#include <type_traits>
+#include <kstd/types.hpp>
+#include "pacing.hpp"
+#include "protocol.hpp"
+#include "trace.hpp"
+
+namespace fox::serial {
+    struct FlowControlPolicy final {
+        kstd::u32 window_size;                  // Maximum number of unacknowledged messages, 0 for unlimited
+        std::chrono::milliseconds ack_timeout;  // Time after which a message is considered lost
+        kstd::u32 max_retransmits;              // How often a lost message is sent again before giving up
+    };
+
+    /**
+     * In-flight messages are matched against acknowledgements by key. For the
+     * legacy protocol that is the feedback the message is answered with, for
+     * the binary protocol it is the sequence number of the frame.
+     */
+    [[nodiscard]] constexpr auto make_feedback_key(Feedback feedback) noexcept -> kstd::u16 {
+        return static_cast<kstd::u16>(feedback);
+    }
+
+    [[nodiscard]] constexpr auto make_sequence_key(kstd::u8 sequence) noexcept -> kstd::u16 {
+        return static_cast<kstd::u16>(0x100 | sequence);
+    }
+
+    constexpr kstd::u32 MAX_NACK_RETRANSMITS = 3; // Independent of the policy, the device explicitly asked for these
+
+    struct InFlightMessage final {
+        kstd::u16 key;
+        std::array<char, MAX_FRAME_SIZE> packet;
+        kstd::usize packet_size;
+        Clock::time_point sent_at;
+        Clock::time_point first_sent_at;
+        kstd::u32 num_retransmits;
+        kstd::u32 num_nack_retransmits;
+        kstd::u32 trace_id;
+
+        [[nodiscard]] inline auto get_packet() const noexcept -> std::string_view {
+            return {packet.data(), packet_size};
+        }
+    };
+
+    struct Acknowledgement final {
+        Clock::duration round_trip_time; // Measured from the first transmission
+        kstd::u32 trace_id;              // Of the command the acknowledged message belongs to
+    };
+
+    /**
+     * Credit based flow control for the device link. Every sent message which the
+     * device acknowledges with a feedback line occupies one slot of the window
+     * until the matching feedback arrives or the message times out.
+     */
+    class FlowControl final {
+        FlowControlPolicy _policy;
+        std::deque<InFlightMessage> _in_flight;
+
+        public:
+
+        explicit FlowControl(const FlowControlPolicy& policy) noexcept:
+                _policy(policy),
+                _in_flight() {
+        }
+
+        [[nodiscard]] inline auto get_credits() const noexcept -> kstd::u32 {
+            if (_policy.window_size == 0) {
+                return std::numeric_limits<kstd::u32>::max();
+            }
+
+            const auto num_in_flight = static_cast<kstd::u32>(_in_flight.size());
+            return num_in_flight < _policy.window_size ? _policy.window_size - num_in_flight : 0;
+        }
+
+        inline auto on_sent(kstd::u16 key, std::string_view packet, Clock::time_point now, kstd::u32 trace_id = NO_TRACE) noexcept -> void {
+            InFlightMessage message{key, {}, std::min(packet.size(), MAX_FRAME_SIZE), now, now, 0, 0, trace_id};
+            std::copy_n(packet.begin(), message.packet_size, message.packet.begin());
+            _in_flight.push_back(message);
+        }
+
+        /**
+         * Acknowledges the oldest in-flight message with the given key.
+         * @return The acknowledged message, or std::nullopt if the acknowledgement was unsolicited.
+         */
+        inline auto on_acknowledged(kstd::u16 key, Clock::time_point now) noexcept -> std::optional<Acknowledgement> {
+            const auto itr = std::find_if(_in_flight.begin(), _in_flight.end(), [key](const auto& entry) {
+                return entry.key == key;
+            });
+
+            if (itr == _in_flight.end()) {
+                return std::nullopt;
+            }
+
+            const Acknowledgement acknowledgement{now - itr->first_sent_at, itr->trace_id};
+            _in_flight.erase(itr);
+            return acknowledgement;
+        }
+
+        /**
+         * Immediately sends the in-flight message with the given key again,
+         * used when the device reports that it received a corrupted copy.
+         * These retransmits have their own budget of MAX_NACK_RETRANSMITS, so
+         * they also happen when timeouts are configured not to retransmit.
+         * @return False if there is no such message or it ran out of retransmits.
+         */
+        template<typename F>
+        requires(std::is_invocable_v<F, std::string_view>)
+        inline auto retransmit(kstd::u16 key, Clock::time_point now, F&& retransmit) noexcept -> bool {
+            const auto itr = std::find_if(_in_flight.begin(), _in_flight.end(), [key](const auto& entry) {
+                return entry.key == key;
+            });
+
+            if (itr == _in_flight.end() || itr->num_nack_retransmits >= MAX_NACK_RETRANSMITS) {
+                return false;
+            }
+
+            ++itr->num_nack_retransmits;
+            itr->sent_at = now;
+            retransmit(itr->get_packet());
+            return true;
+        }
+
+        /**
+         * Handles all messages whose acknowledgement timed out. Messages with retransmits
+         * left are passed to the given function and stay in flight, all others are dropped.
+         * @return The number of dropped messages.
+         */
+        template<typename F>
+        requires(std::is_invocable_v<F, std::string_view>)
+        inline auto collect_expired(Clock::time_point now, F&& retransmit) noexcept -> kstd::u32 {
+            kstd::u32 num_dropped = 0;
+
+            for (auto itr = _in_flight.begin(); itr != _in_flight.end();) {
+                if (itr->sent_at + _policy.ack_timeout > now) {
+                    ++itr;
+                    continue;
+                }
+
+                if (itr->num_retransmits < _policy.max_retransmits) {
+                    ++itr->num_retransmits;
+                    itr->sent_at = now;
+                    retransmit(itr->get_packet());
+                    ++itr;
+                    continue;
+                }
+
+                itr = _in_flight.erase(itr);
+                ++num_dropped;
+            }
+
+            return num_dropped;
+        }
+
+        [[nodiscard]] inline auto get_next_deadline() const noexcept -> std::optional<Clock::time_point> {
+            if (_in_flight.empty()) {
+                return std::nullopt;
+            }
+
+            const auto itr = std::min_element(_in_flight.begin(), _in_flight.end(), [](const auto& a, const auto& b) {
+                return a.sent_at < b.sent_at;
+            });
+
+            return itr->sent_at + _policy.ack_timeout;
+        }
+
+        [[nodiscard]] inline auto get_num_in_flight() const noexcept -> kstd::u32 {
+            return static_cast<kstd::u32>(_in_flight.size());
+        }
+    };
+}
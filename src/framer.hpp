@@ -0,0 +1,113 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <string_view>
+#include <cstring>
+#include <sys/uio.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Splits a byte stream into newline terminated lines using a fixed ring buffer.
+     * Data is pulled in with a single readv per call, lines are handed out as
+     * views into the ring and only lines wrapping around the end of the ring
+     * are copied into a scratch buffer, so no heap allocations take place.
+     */
+    template<kstd::usize CAPACITY>
+    requires((CAPACITY & (CAPACITY - 1)) == 0)
+    class LineFramer final {
+        static constexpr kstd::usize MASK = CAPACITY - 1;
+
+        std::array<char, CAPACITY> _buffer;
+        std::array<char, CAPACITY> _line;
+        kstd::usize _head;
+        kstd::usize _tail;
+        kstd::usize _scan;
+
+        public:
+
+        LineFramer() noexcept:
+                _buffer(),
+                _line(),
+                _head(0),
+                _tail(0),
+                _scan(0) {
+        }
+
+        /**
+         * Reads as many bytes as currently fit into the ring.
+         * @return The number of bytes read, 0 on EOF or -1 on error (see errno).
+         */
+        inline auto read_from(kstd::i32 handle) noexcept -> kstd::isize {
+            if (_tail - _head == CAPACITY) {
+                reset(); // A line longer than the whole ring is garbage anyway
+            }
+
+            const auto free = CAPACITY - (_tail - _head);
+            const auto start = _tail & MASK;
+            const auto first_size = std::min(free, CAPACITY - start);
+
+            iovec vectors[2] = {
+                {_buffer.data() + start, first_size},
+                {_buffer.data(), free - first_size}
+            };
+
+            const auto result = ::readv(handle, vectors, vectors[1].iov_len > 0 ? 2 : 1);
+
+            if (result > 0) {
+                _tail += static_cast<kstd::usize>(result);
+            }
+
+            return result;
+        }
+
+        /**
+         * Yields the next complete line without its terminator and trailing '\r'.
+         * The returned view stays valid until the next call to read_from or next_line.
+         */
+        [[nodiscard]] inline auto next_line() noexcept -> std::optional<std::string_view> {
+            for (; _scan < _tail; ++_scan) {
+                if (_buffer[_scan & MASK] != '\n') {
+                    continue;
+                }
+
+                const auto start = _head & MASK;
+                auto size = _scan - _head;
+                _head = ++_scan;
+
+                const char* data = _buffer.data() + start;
+
+                if (start + size > CAPACITY) {
+                    const auto first_size = CAPACITY - start;
+                    std::memcpy(_line.data(), data, first_size);
+                    std::memcpy(_line.data() + first_size, _buffer.data(), size - first_size);
+                    data = _line.data();
+                }
+
+                if (size > 0 && data[size - 1] == '\r') {
+                    --size;
+                }
+
+                return std::string_view(data, size);
+            }
+
+            return std::nullopt;
+        }
+
+        inline auto reset() noexcept -> void {
+            _head = _tail;
+            _scan = _tail;
+        }
+
+        [[nodiscard]] inline auto get_size() const noexcept -> kstd::usize {
+            return _tail - _head;
+        }
+    };
+}
@@ -6,31 +6,99 @@
 #include <spdlog/spdlog.h>
 #include <httplib.h>
 #include <nlohmann/json.hpp>
+#include <array>
 #include <exception>
 #include "gateway.hpp"
+#include "event_stream.hpp"
+#include "backoff.hpp"
+#include "circuit_breaker.hpp"
+#include "json_writer.hpp"
+#include "binary_writer.hpp"
+#include "wire_format.hpp"
+#include "task_parser.hpp"
+#include "metrics.hpp"
 #include "dto.hpp"
 #include "monitor.hpp"
 #include "server.hpp"
 
-#define FOX_JSON_MIME_TYPE "application/json"
 
 namespace fox {
-    Gateway::Gateway(Server& server, std::string address, kstd::u32 port, kstd::u32 update_rate, std::string certificate_path, std::string password) noexcept:
-            _client(address, static_cast<int>(port)),
+    Gateway::Gateway(Server& server, std::string address, kstd::u32 port, kstd::u32 update_rate, kstd::u32 idle_update_rate, Transport transport, WireFormat wire_format, std::string certificate_path, std::string password) noexcept:
+            _fetch_connection(address, port, certificate_path),
+            _publish_connection(address, port, certificate_path),
+            _stream_connection(address, port, certificate_path),
             _server(server),
             _address(std::move(address)),
             _port(port),
             _update_rate(update_rate),
+            _idle_update_rate(std::max(idle_update_rate, update_rate)),
+            _transport(transport),
+            _wire_format(wire_format),
             _is_running(true),
+            _is_streaming(false),
+            _broadcast_version(0),
+            _last_broadcast(),
+            _outbound(),
+            _breaker(CIRCUIT_FAILURE_THRESHOLD, CIRCUIT_MIN_OPEN_TIME, CIRCUIT_MAX_OPEN_TIME),
+            _num_retries(0),
             _certificate_path(std::move(certificate_path)),
             _password(std::move(password)),
             _monitor() {
-        _thread = std::thread(update_loop, this);
+        spdlog::info("Connecting to {}:{}", _address, _port);
+
+        _outbound.push(Outbound::ONLINE);
+        _outbound.push(Outbound::SESSION);
+        _outbound.push(Outbound::STATE);
+        _server.attach_gateway(this);
+
+        _fetch_thread.start([this] {
+            fetch_loop(this);
+        });
+
+        _publish_thread.start([this] {
+            publish_loop(this);
+        });
+
+        if (_transport == Transport::STREAM) {
+            _stream_thread.start([this] {
+                stream_loop(this);
+            });
+        }
     }
 
     Gateway::~Gateway() noexcept {
+        _server.attach_gateway(nullptr);
         _is_running = false;
-        _thread.join();
+        // Interrupt requests which are being held open by the gateway
+        _fetch_connection.stop();
+        _stream_connection.stop();
+        // The publisher reports going offline before it exits
+        _outbound.close();
+        // All workers share one deadline, a gateway which stopped answering must not stall the shutdown
+        const auto deadline = std::chrono::steady_clock::now() + GATEWAY_JOIN_TIMEOUT;
+
+        for (auto* thread: {&_publish_thread, &_fetch_thread, &_stream_thread}) {
+            while (!thread->join_for(GATEWAY_STOP_INTERVAL)) {
+                const auto now = std::chrono::steady_clock::now();
+
+                // A worker may have started another request after the connections were stopped
+                _fetch_connection.stop();
+                _stream_connection.stop();
+
+                if (now < deadline) {
+                    continue;
+                }
+
+                // Out of time for reporting going offline
+                _publish_connection.stop();
+
+                if (now >= deadline + THREAD_JOIN_TIMEOUT) {
+                    spdlog::critical("Gateway worker could not be interrupted, exiting");
+                    spdlog::shutdown();
+                    BoundedThread::abandon();
+                }
+            }
+        }
     }
 
     auto Gateway::reset_session() noexcept -> void {
@@ -38,13 +106,112 @@ namespace fox {
         _session_password.clear();
         _session_password_mutex.unlock();
 
-        broadcast_is_online(this, false);
-        broadcast_is_online(this, true);
-        create_session(this);
+        _outbound.push(Outbound::OFFLINE);
+        _outbound.push(Outbound::ONLINE);
+        _outbound.push(Outbound::SESSION);
+    }
+
+    auto Gateway::notify_state_changed() noexcept -> void {
+        if (!_outbound.push(Outbound::STATE)) {
+            spdlog::warn("Gateway publish queue is full, state update deferred to the next heartbeat");
+        }
+    }
+
+    auto Gateway::sleep(Gateway* self, std::chrono::milliseconds duration) noexcept -> void {
+        using namespace std::chrono_literals;
+
+        // Sliced so shutting down never waits for a long retry delay
+        const auto until = std::chrono::steady_clock::now() + duration;
+
+        while (self->_is_running && std::chrono::steady_clock::now() < until) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(100ms, until - std::chrono::steady_clock::now()));
+        }
+    }
+
+    auto Gateway::get_retry_delay(Gateway* self, ExponentialBackoff& backoff) noexcept -> std::chrono::milliseconds {
+        ++self->_num_retries;
+        return std::max(backoff.next(), self->_breaker.get_remaining_open_time());
+    }
+
+    auto Gateway::record_outcome(Gateway* self, bool is_success) noexcept -> void {
+        auto& breaker = self->_breaker;
+
+        if (!is_success) {
+            if (breaker.on_failure()) {
+                spdlog::warn("Gateway is unavailable, pausing requests for {}ms", breaker.get_remaining_open_time().count());
+            }
+
+            return;
+        }
+
+        if (!breaker.on_success()) {
+            return;
+        }
+
+        // The gateway may have lost everything it knew about us while it was down
+        spdlog::info("Gateway is available again, re-creating session");
+        // Flapping between failures and successes must not pile up copies of the same requests
+        self->_outbound.push_unique(Outbound::ONLINE);
+        self->_outbound.push_unique(Outbound::SESSION);
+        self->_outbound.push_unique(Outbound::STATE);
+    }
+
+    template<typename W>
+    auto Gateway::write_credentials(Gateway* self, W& writer) noexcept -> void {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        writer.field("password", std::string_view(self->_password));
+        writer.field("timestamp", static_cast<kstd::u64>(timestamp));
+    }
+
+    template<typename F>
+    auto Gateway::post(Gateway* self, HttpsConnection& connection, const std::string& path, F&& write_body) noexcept -> std::optional<httplib::Result> {
+        // Indexed by WireFormat, built once so sending doesn't allocate them
+        static const std::array<std::string, 3> mime_types{get_mime_type(WireFormat::JSON), get_mime_type(WireFormat::CBOR), get_mime_type(WireFormat::MSGPACK)};
+        static const std::array<httplib::Headers, 3> headers{
+            httplib::Headers{{"Accept", get_accept_header(WireFormat::JSON)}},
+            httplib::Headers{{"Accept", get_accept_header(WireFormat::CBOR)}},
+            httplib::Headers{{"Accept", get_accept_header(WireFormat::MSGPACK)}}
+        };
+
+        if (!self->_breaker.try_acquire()) {
+            return std::nullopt;
+        }
+
+        const auto format = self->_wire_format.load();
+        const auto body = encode_document(format, get_thread_json_buffer(), write_body);
+        const auto index = static_cast<kstd::usize>(format);
+        auto result = connection.post(path, headers[index], body, mime_types[index]);
+        metrics::gateway_requests.add();
+        // Client errors are answered by a healthy gateway, retrying them sooner won't help either
+        record_outcome(self, result && result->status < 500);
+
+        if (result && result->status == 415 && format != WireFormat::JSON) {
+            spdlog::warn("Gateway does not accept {} bodies, falling back to JSON", get_wire_format_name(format));
+            self->_wire_format = WireFormat::JSON;
+            return post(self, connection, path, std::forward<F>(write_body));
+        }
+
+        return result;
+    }
+
+    auto Gateway::get_connection_stats() const noexcept -> ConnectionStats {
+        ConnectionStats total{};
+
+        for (const auto* connection: {&_fetch_connection, &_publish_connection, &_stream_connection}) {
+            const auto stats = connection->get_stats();
+            total.num_requests += stats.num_requests;
+            total.num_failures += stats.num_failures;
+            total.num_handshakes += stats.num_handshakes;
+            total.num_resumed_handshakes += stats.num_resumed_handshakes;
+            total.handshakes_per_minute += stats.handshakes_per_minute;
+        }
+
+        return total;
     }
 
     auto Gateway::check_status(const httplib::Result& res) noexcept -> bool {
         if (!res) {
+            metrics::gateway_errors.add();
             spdlog::error("Could not session data: invalid response");
             return false;
         }
@@ -55,8 +222,10 @@ namespace fox {
             return true;
         }
 
+        metrics::gateway_errors.add();
+
         try {
-            const auto res_body = nlohmann::json::parse(res->body);
+            const auto res_body = decode_document(res->body, get_wire_format_of(res->get_header_value("Content-Type")));
 
             if (res_body.contains("error")) {
                 spdlog::error("Could not fetch session data: code {}/{}", status, res_body["error"]);
@@ -72,131 +241,308 @@ namespace fox {
         return false;
     }
 
-    auto Gateway::update_loop(Gateway* self) noexcept -> void {
-        using namespace std::chrono_literals;
+    auto Gateway::apply_tasks(Gateway* self, const TaskListParser& parser, TraceClock::time_point received_at) noexcept -> kstd::usize {
+        for (const auto& [index, reason, field]: parser.get_errors()) {
+            if (field.empty()) {
+                spdlog::warn("Skipping task #{}: {}", index, reason);
+                continue;
+            }
 
-        spdlog::info("Starting gateway client");
-        auto& client = self->_client;
+            spdlog::warn("Skipping task #{}: {} '{}'", index, reason, field);
+        }
 
-        client.set_ca_cert_path(self->_certificate_path);
-        client.enable_server_certificate_verification(false);
-        client.set_default_headers({std::make_pair("Cache-Control", "private,max-age=0")}); // https://developers.cloudflare.com/cache/about/cache-control/
+        const auto& tasks = parser.get_tasks();
 
-        const auto address = self->_address;
-        const auto port = static_cast<int>(self->_port);
-        spdlog::info("Connecting to {}:{}", address, port);
+        if (tasks.empty()) {
+            return 0;
+        }
 
-        broadcast_is_online(self, true);
+        // Only the net change of the batch is applied, so a burst of slider updates becomes a single speed task
+        const auto num_applied = self->_server.apply_tasks(tasks, received_at);
 
-        if (!create_session(self)) {
-            return;
+        if (auto* monitor = self->_monitor; monitor != nullptr) {
+            monitor->log_gateway(fmt::format("Fetched {} tasks from endpoint, applying {}", tasks.size(), num_applied));
         }
 
-        auto& server = self->_server;
+        return tasks.size();
+    }
 
-        while (self->_is_running) {
-            auto req_body = nlohmann::json::object();
-            req_body["password"] = self->_password;
-            req_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    auto Gateway::fetch_tasks(Gateway* self) noexcept -> FetchResult {
+        const auto start = std::chrono::steady_clock::now();
+        const auto response = post(self, self->_fetch_connection, "/fetch", [self](auto& writer) {
+            writer.begin_object();
+            write_credentials(self, writer);
+
+            if (self->_transport != Transport::POLL) {
+                // Gateways which don't know about long polling ignore this and answer right away
+                writer.field("wait", LONG_POLL_TIMEOUT.count());
+            }
+
+            writer.end_object();
+        });
+
+        if (response) {
+            metrics::gateway_fetch.observe(std::chrono::steady_clock::now() - start);
+        }
+
+        if (!response || !check_status(*response)) {
+            return {};
+        }
 
-            const auto response = client.Post("/fetch", req_body.dump(), FOX_JSON_MIME_TYPE);
+        const auto received_at = TraceClock::now();
 
-            if (!check_status(response)) {
+        // Only used by the fetch thread, so its buffers are reused across requests
+        thread_local TaskListParser parser;
+
+        if (!parser.parse((*response)->body, get_wire_format_of((*response)->get_header_value("Content-Type"))) || !parser.has_tasks()) {
+            spdlog::warn("Malformed response body: {}", parser.get_parse_error().empty() ? "no task list" : parser.get_parse_error());
+            return {};
+        }
+
+        return {true, parser.is_long_poll(), apply_tasks(self, parser, received_at)};
+    }
+
+    auto Gateway::fetch_loop(Gateway* self) noexcept -> void {
+        using namespace std::chrono_literals;
+
+        spdlog::info("Starting gateway client");
+        // Held requests must not run into the read timeout
+        self->_fetch_connection.get_client().set_read_timeout(LONG_POLL_TIMEOUT + 10s);
+
+        auto& server = self->_server;
+        ExponentialBackoff interval(std::chrono::milliseconds(self->_update_rate), std::chrono::milliseconds(self->_idle_update_rate));
+        ExponentialBackoff retry(RETRY_MIN_DELAY, RETRY_MAX_DELAY);
+
+        while (self->_is_running) {
+            // While tasks are pushed through the event stream there is nothing to fetch
+            if (self->_is_streaming) {
+                sleep(self, std::chrono::milliseconds(self->_update_rate));
                 continue;
             }
 
-            const auto res_body = nlohmann::json::parse(response->body);
+            const auto result = fetch_tasks(self);
 
-            if (!res_body.is_object() || !res_body.contains("tasks")) {
-                spdlog::warn("Malformed response body");
+            if (!result.is_successful) {
+                sleep(self, get_retry_delay(self, retry));
                 continue;
             }
 
-            const auto& tasks = res_body["tasks"];
+            retry.reset();
 
-            if (!tasks.is_array()) {
-                spdlog::warn("Tasks list must be an array");
+            if (result.is_held || !self->_is_running) {
                 continue;
             }
 
-            auto* monitor = self->_monitor;
+            // Poll quickly while somebody is interacting with the device, then gradually back off
+            if (result.num_tasks > 0 || server.get_actual_speed() != server.get_target_speed()) {
+                interval.reset();
+            }
+
+            sleep(self, interval.next());
+        }
+    }
+
+    auto Gateway::publish_loop(Gateway* self) noexcept -> void {
+        spdlog::info("Starting gateway publisher");
+        auto& outbound = self->_outbound;
+        ExponentialBackoff retry(RETRY_MIN_DELAY, RETRY_MAX_DELAY);
+
+        while (true) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto heartbeat_at = self->_last_broadcast + STATE_HEARTBEAT_INTERVAL;
+            auto message = outbound.peek(heartbeat_at > now ? heartbeat_at - now : std::chrono::steady_clock::duration::zero());
+            const auto is_heartbeat = !message;
+
+            if (is_heartbeat) {
+                if (outbound.is_closed()) {
+                    break;
+                }
+
+                message = Outbound::STATE;
 
-            if (monitor != nullptr) {
-                monitor->log_gateway(fmt::format("Fetched {} tasks from endpoint", tasks.size()));
+                const auto stats = self->get_connection_stats();
+                const auto circuit_stats = self->_breaker.get_stats();
+                spdlog::debug("Gateway connections: {} requests, {} failed, {} handshakes ({} resumed, {} in the last minute)", stats.num_requests, stats.num_failures, stats.num_handshakes, stats.num_resumed_handshakes, stats.handshakes_per_minute);
+                spdlog::debug("Gateway circuit: {}, {} trips, {} rejected, {} retries", get_circuit_state_name(circuit_stats.state), circuit_stats.num_trips, circuit_stats.num_rejected, self->_num_retries.load());
             }
 
-            for (const auto& task: tasks) {
-                dto::Task task_dto{};
-                task_dto.deserialize(task);
+            auto is_sent = true;
+
+            switch (*message) {
+                case Outbound::ONLINE:
+                    is_sent = broadcast_is_online(self, true);
+                    break;
+                case Outbound::OFFLINE:
+                    is_sent = broadcast_is_online(self, false);
+                    break;
+                case Outbound::SESSION:
+                    is_sent = create_session(self);
+                    break;
+                case Outbound::STATE:
+                    is_sent = broadcast_state(self);
+                    break;
+            }
 
-                switch (task_dto.type) {
-                    case dto::TaskType::POWER:
-                        server.set_is_on(task_dto.power.is_on);
-                        break;
-                    case dto::TaskType::SPEED:
-                        server.set_speed(task_dto.speed.speed);
-                        break;
-                    case dto::TaskType::MODE:
-                        server.set_mode(task_dto.mode.mode);
-                        break;
+            if (is_sent) {
+                if (!is_heartbeat) {
+                    outbound.pop();
                 }
+
+                retry.reset();
+                continue;
             }
 
-            broadcast_state(self);
-            std::this_thread::sleep_for(std::chrono::milliseconds(self->_update_rate));
+            // Nothing is ever dropped, the session has to be created eventually for the server to be usable.
+            // The message stays at the head and is retried in place, so nothing queued after it can overtake it.
+            sleep(self, get_retry_delay(self, retry));
         }
 
         broadcast_is_online(self, false);
     }
 
-    auto Gateway::broadcast_is_online(Gateway* self, bool is_online) noexcept -> void {
-        auto& client = self->_client;
+    auto Gateway::stream_loop(Gateway* self) noexcept -> void {
+        using namespace std::chrono_literals;
+
+        spdlog::info("Starting gateway event stream");
+        auto& connection = self->_stream_connection;
+        // The gateway sends keep-alive comments, so a silent stream is a dead stream
+        connection.get_client().set_read_timeout(LONG_POLL_TIMEOUT + 10s);
+
+        EventStreamParser parser;
+        TaskListParser task_parser;
+
+        while (self->_is_running) {
+            parser.reset();
+
+            httplib::Headers headers{
+                {"Accept", "text/event-stream"},
+                {"X-Fox-Password", self->_password}
+            };
 
-        auto req_body = nlohmann::json::object();
-        req_body["password"] = self->_password;
-        req_body["is_online"] = is_online;
-        req_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+            // Resume right after the last task list which was received completely, so nothing is lost in between
+            if (!parser.get_last_event_id().empty()) {
+                headers.emplace("Last-Event-ID", parser.get_last_event_id());
+            }
 
-        check_status(client.Post("/setonline", req_body.dump(), FOX_JSON_MIME_TYPE));
+            if (!self->_breaker.try_acquire()) {
+                sleep(self, std::max(self->_breaker.get_remaining_open_time(), std::chrono::duration_cast<std::chrono::milliseconds>(STREAM_RETRY_DELAY)));
+                continue;
+            }
+
+            auto is_answered = false;
+
+            const auto on_response = [self, &is_answered](const httplib::Response& response) {
+                is_answered = true;
+                record_outcome(self, response.status < 500);
+
+                if (response.status != 200) {
+                    spdlog::warn("Gateway does not support event streams ({}), falling back to polling", response.status);
+                    return false;
+                }
+
+                spdlog::info("Receiving tasks through event stream");
+                self->_is_streaming = true;
+                return true;
+            };
+
+            const auto on_content = [self, &parser, &task_parser](const char* data, size_t size) {
+                const auto received_at = TraceClock::now();
+
+                parser.feed(std::string_view(data, size), [self, &task_parser, received_at](std::string_view event, std::string_view data) {
+                    if (event != "tasks") {
+                        return;
+                    }
+
+                    if (!task_parser.parse(data) || !task_parser.has_tasks()) {
+                        spdlog::warn("Malformed event stream data: {}", task_parser.get_parse_error().empty() ? "no task list" : task_parser.get_parse_error());
+                        return;
+                    }
+
+                    apply_tasks(self, task_parser, received_at);
+                });
+
+                return self->_is_running.load();
+            };
+
+            connection.get("/events", headers, on_response, on_content);
+
+            if (!is_answered) {
+                record_outcome(self, false);
+            }
+
+            if (self->_is_streaming.exchange(false) && self->_is_running) {
+                spdlog::warn("Lost event stream, falling back to polling");
+            }
+
+            sleep(self, STREAM_RETRY_DELAY);
+        }
+    }
+
+    auto Gateway::broadcast_is_online(Gateway* self, bool is_online) noexcept -> bool {
+        auto& connection = self->_publish_connection;
+
+        const auto response = post(self, connection, "/setonline", [self, is_online](auto& writer) {
+            writer.begin_object();
+            write_credentials(self, writer);
+            writer.field("is_online", is_online);
+            writer.end_object();
+        });
+
+        return response && check_status(*response);
     }
 
-    auto Gateway::broadcast_state(Gateway* self) noexcept -> void {
-        auto& client = self->_client;
+    auto Gateway::broadcast_state(Gateway* self) noexcept -> bool {
+        auto& connection = self->_publish_connection;
         auto& server = self->_server;
 
-        dto::DeviceState state{};
-        state.is_on = server.is_on();
-        state.accepts_commands = server.accepts_commands();
-        state.target_speed = server.get_target_speed();
-        state.actual_speed = server.get_actual_speed();
-        state.mode = server.get_mode();
+        // Read the version first, so changes racing with the snapshot below are sent next time
+        const auto version = server.get_state_version();
+        const auto now = std::chrono::steady_clock::now();
+        const auto is_heartbeat_due = now - self->_last_broadcast >= STATE_HEARTBEAT_INTERVAL;
 
-        auto req_body = nlohmann::json::object();
-        req_body["password"] = self->_password;
-        req_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        if (version == self->_broadcast_version && !is_heartbeat_due) {
+            return true;
+        }
 
-        auto state_obj = nlohmann::json::object();
-        state.serialize(state_obj);
-        req_body["state"] = state_obj;
+        const auto state = server.get_state_snapshot();
 
-        check_status(client.Post("/setstate", req_body.dump(), FOX_JSON_MIME_TYPE));
+        const auto response = post(self, connection, "/setstate", [self, &state](auto& writer) {
+            writer.begin_object();
+            write_credentials(self, writer);
+            writer.key("state");
+            write_object(writer, state);
+            writer.end_object();
+        });
+
+        if (!response || !check_status(*response)) {
+            metrics::gateway_setstate_failures.add();
+            return false;
+        }
+
+        self->_broadcast_version = version;
+        self->_last_broadcast = now;
+        return true;
     }
 
     auto Gateway::create_session(Gateway* self) noexcept -> bool {
-        auto req_body = nlohmann::json::object();
-        req_body["password"] = self->_password;
-        req_body["timestamp"] = static_cast<kstd::u64>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+        const auto response = post(self, self->_publish_connection, "/newsession", [self](auto& writer) {
+            writer.begin_object();
+            write_credentials(self, writer);
+            writer.end_object();
+        });
 
-        const auto response = self->_client.Post("/newsession", req_body.dump(), FOX_JSON_MIME_TYPE);
+        if (!response) {
+            return false;
+        }
 
-        if (!check_status(response)) {
+        if (!check_status(*response)) {
             spdlog::warn("Received invalid new session response");
             return false;
         }
 
-        auto res_body = nlohmann::json::parse(response->body);
+        const auto res_body = decode_document((*response)->body, get_wire_format_of((*response)->get_header_value("Content-Type")));
 
-        if (!res_body.contains("password")) {
+        if (!res_body.is_object() || !res_body.contains("password") || !res_body["password"].is_string()) {
             spdlog::warn("Received invalid new session response");
             return false;
         }
@@ -9,23 +9,93 @@
 #include <string_view>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <optional>
 #include <shared_mutex>
 #include <httplib.h>
+#include <nlohmann/json_fwd.hpp>
 #include <kstd/types.hpp>
+#include "outbound_queue.hpp"
+#include "connection.hpp"
+#include "backoff.hpp"
+#include "circuit_breaker.hpp"
+#include "json_writer.hpp"
+#include "wire_format.hpp"
+#include "lifecycle.hpp"
+#include "trace.hpp"
 
 namespace fox {
     class Monitor;
 
     class Server;
 
+    class TaskListParser;
+
+    constexpr std::chrono::milliseconds LONG_POLL_TIMEOUT(20000);
+    constexpr std::chrono::milliseconds STREAM_RETRY_DELAY(5000);
+    constexpr std::chrono::milliseconds STATE_HEARTBEAT_INTERVAL(30000);
+    constexpr kstd::usize OUTBOUND_QUEUE_CAPACITY = 16;
+    constexpr std::chrono::milliseconds RETRY_MIN_DELAY(250);
+    constexpr std::chrono::milliseconds RETRY_MAX_DELAY(30000);
+    constexpr kstd::u32 CIRCUIT_FAILURE_THRESHOLD = 5;
+    constexpr std::chrono::milliseconds CIRCUIT_MIN_OPEN_TIME(1000);
+    constexpr std::chrono::milliseconds CIRCUIT_MAX_OPEN_TIME(60000);
+    constexpr std::chrono::milliseconds GATEWAY_JOIN_TIMEOUT(5000); // Leaves the publisher time to report going offline
+    constexpr std::chrono::milliseconds GATEWAY_STOP_INTERVAL(100); // How often requests are interrupted again while joining
+
+    /**
+     * How tasks are received from the gateway. Push based transports fall
+     * back to periodic polling whenever the gateway does not support them.
+     */
+    enum class Transport : kstd::u8 {
+        POLL,       // POST /fetch every update_rate milliseconds
+        LONG_POLL,  // POST /fetch which the gateway holds until tasks are available
+        STREAM      // GET /events as server-sent events, tasks are pushed as they are created and resumed by Last-Event-ID
+    };
+
+    [[nodiscard]] constexpr auto parse_transport(std::string_view name) noexcept -> std::optional<Transport> {
+        if (name == "poll") {
+            return Transport::POLL;
+        }
+
+        if (name == "longpoll") {
+            return Transport::LONG_POLL;
+        }
+
+        if (name == "stream") {
+            return Transport::STREAM;
+        }
+
+        return std::nullopt;
+    }
+
+    struct FetchResult final {
+        bool is_successful;
+        bool is_held;           // The gateway held the request until tasks were available
+        kstd::usize num_tasks;
+    };
+
     class Gateway final {
-        httplib::SSLClient _client;
+        HttpsConnection _fetch_connection;
+        HttpsConnection _publish_connection;
+        HttpsConnection _stream_connection;
         Server& _server;
         std::string _address;
         kstd::u32 _port;
         kstd::u32 _update_rate;
-        std::thread _thread;
+        kstd::u32 _idle_update_rate;
+        Transport _transport;
+        std::atomic<WireFormat> _wire_format;
+        BoundedThread _fetch_thread;
+        BoundedThread _publish_thread;
+        BoundedThread _stream_thread;
         std::atomic_bool _is_running;
+        std::atomic_bool _is_streaming;
+        kstd::u64 _broadcast_version;
+        std::chrono::steady_clock::time_point _last_broadcast;
+        OutboundQueue<OUTBOUND_QUEUE_CAPACITY> _outbound;
+        CircuitBreaker _breaker;
+        std::atomic_uint64_t _num_retries;
         std::string _certificate_path;
         std::string _password;
         std::string _session_password;
@@ -34,22 +104,73 @@ namespace fox {
 
         static auto check_status(const httplib::Result& res) noexcept -> bool;
 
-        static auto broadcast_is_online(Gateway* self, bool is_online) noexcept -> void;
+        static auto sleep(Gateway* self, std::chrono::milliseconds duration) noexcept -> void;
+
+        static auto get_retry_delay(Gateway* self, ExponentialBackoff& backoff) noexcept -> std::chrono::milliseconds;
+
+        static auto record_outcome(Gateway* self, bool is_success) noexcept -> void;
+
+        /**
+         * Sends a request through the circuit breaker shared by all gateway calls.
+         * The body is encoded in the current wire format by calling write_body with
+         * either a JsonWriter or a BinaryWriter. If the gateway rejects a binary
+         * body as unsupported, the request is repeated as JSON.
+         * @return The result, or std::nullopt if the circuit breaker rejected the request.
+         */
+        template<typename F>
+        static auto post(Gateway* self, HttpsConnection& connection, const std::string& path, F&& write_body) noexcept -> std::optional<httplib::Result>;
+
+        template<typename W>
+        static auto write_credentials(Gateway* self, W& writer) noexcept -> void;
 
-        static auto broadcast_state(Gateway* self) noexcept -> void;
+        static auto broadcast_is_online(Gateway* self, bool is_online) noexcept -> bool;
+
+        /**
+         * Sends the device state if it changed since the gateway last accepted
+         * it, or as a heartbeat if nothing was sent for a while.
+         * @return False if the gateway did not accept the state.
+         */
+        static auto broadcast_state(Gateway* self) noexcept -> bool;
 
         static auto create_session(Gateway* self) noexcept -> bool;
 
-        static auto update_loop(Gateway* self) noexcept -> void;
+        /**
+         * Applies the net change of the valid tasks of a parsed task list to
+         * the server and reports the rejected ones.
+         * @return The number of valid tasks, including the ones which were collapsed.
+         */
+        static auto apply_tasks(Gateway* self, const TaskListParser& parser, TraceClock::time_point received_at) noexcept -> kstd::usize;
+
+        static auto fetch_tasks(Gateway* self) noexcept -> FetchResult;
+
+        /**
+         * Inbound worker, fetches tasks and applies them to the server. Without long polling
+         * the interval starts at the update rate whenever there is activity and
+         * backs off exponentially towards the idle update rate otherwise.
+         */
+        static auto fetch_loop(Gateway* self) noexcept -> void;
+
+        /**
+         * Outbound worker, publishes state and session changes so slow
+         * round trips never hold up fetching the next tasks.
+         */
+        static auto publish_loop(Gateway* self) noexcept -> void;
+
+        static auto stream_loop(Gateway* self) noexcept -> void;
 
         public:
 
-        Gateway(Server& server, std::string address, kstd::u32 port, kstd::u32 update_rate, std::string certificate_path, std::string password) noexcept;
+        Gateway(Server& server, std::string address, kstd::u32 port, kstd::u32 update_rate, kstd::u32 idle_update_rate, Transport transport, WireFormat wire_format, std::string certificate_path, std::string password) noexcept;
 
         ~Gateway() noexcept;
 
         auto reset_session() noexcept -> void;
 
+        /**
+         * Schedules a state update, called by the server on every change.
+         */
+        auto notify_state_changed() noexcept -> void;
+
         inline auto attach_monitor(Monitor* monitor) noexcept -> void {
             _monitor = monitor;
         }
@@ -70,12 +191,56 @@ namespace fox {
             return _update_rate;
         }
 
+        [[nodiscard]] inline auto get_idle_update_rate() const noexcept -> kstd::u32 {
+            return _idle_update_rate;
+        }
+
+        [[nodiscard]] inline auto get_transport() const noexcept -> Transport {
+            return _transport;
+        }
+
+        /**
+         * @return The format of request bodies, which falls back to JSON if the gateway rejected the configured one.
+         */
+        [[nodiscard]] inline auto get_wire_format() const noexcept -> WireFormat {
+            return _wire_format;
+        }
+
+        [[nodiscard]] inline auto is_streaming() const noexcept -> bool {
+            return _is_streaming;
+        }
+
         [[nodiscard]] inline auto get_server() noexcept -> Server& {
             return _server;
         }
 
-        [[nodiscard]] inline auto get_client() noexcept -> httplib::SSLClient& {
-            return _client;
+        /**
+         * @return The combined statistics of all connections to the gateway.
+         */
+        [[nodiscard]] auto get_connection_stats() const noexcept -> ConnectionStats;
+
+        [[nodiscard]] inline auto get_circuit_stats() const noexcept -> CircuitBreakerStats {
+            return _breaker.get_stats();
+        }
+
+        [[nodiscard]] inline auto get_num_retries() const noexcept -> kstd::u64 {
+            return _num_retries;
+        }
+
+        [[nodiscard]] inline auto is_healthy() const noexcept -> bool {
+            return _fetch_connection.is_healthy() && _publish_connection.is_healthy();
+        }
+
+        [[nodiscard]] inline auto get_fetch_connection() noexcept -> HttpsConnection& {
+            return _fetch_connection;
+        }
+
+        [[nodiscard]] inline auto get_publish_connection() noexcept -> HttpsConnection& {
+            return _publish_connection;
+        }
+
+        [[nodiscard]] inline auto get_stream_connection() noexcept -> HttpsConnection& {
+            return _stream_connection;
         }
 
         [[nodiscard]] inline auto get_session_password() const noexcept -> std::string {
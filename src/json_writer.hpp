@@ -0,0 +1,187 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <concepts>
+#include <type_traits>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Minimal streaming JSON encoder for small, fixed-shape payloads.
+     * Output is appended to a caller provided buffer, so reusing the
+     * buffer means no heap allocations once it has grown large enough.
+     * Nesting is limited to MAX_DEPTH levels, the caller is responsible
+     * for producing a well formed sequence of calls.
+     */
+    class JsonWriter final {
+        static constexpr kstd::usize MAX_DEPTH = 8;
+
+        std::string& _buffer;
+        std::array<bool, MAX_DEPTH> _has_members;
+        kstd::usize _depth;
+        bool _is_after_key;
+
+        inline auto separate() noexcept -> void {
+            if (_is_after_key) {
+                _is_after_key = false;
+                return;
+            }
+
+            if (_depth == 0) {
+                return;
+            }
+
+            if (_has_members[_depth - 1]) {
+                _buffer.push_back(',');
+            }
+
+            _has_members[_depth - 1] = true;
+        }
+
+        inline auto open(char bracket) noexcept -> JsonWriter& {
+            separate();
+            _buffer.push_back(bracket);
+            _has_members[_depth++] = false;
+            return *this;
+        }
+
+        inline auto close(char bracket) noexcept -> JsonWriter& {
+            --_depth;
+            _buffer.push_back(bracket);
+            return *this;
+        }
+
+        inline auto write_string(std::string_view value) noexcept -> void {
+            constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+            _buffer.push_back('"');
+
+            for (const auto character: value) {
+                switch (character) {
+                    case '"':
+                        _buffer.append("\\\"");
+                        break;
+                    case '\\':
+                        _buffer.append("\\\\");
+                        break;
+                    case '\n':
+                        _buffer.append("\\n");
+                        break;
+                    case '\r':
+                        _buffer.append("\\r");
+                        break;
+                    case '\t':
+                        _buffer.append("\\t");
+                        break;
+                    default:
+                        if (static_cast<kstd::u8>(character) < 0x20) {
+                            _buffer.append("\\u00");
+                            _buffer.push_back(HEX_DIGITS[static_cast<kstd::u8>(character) >> 4]);
+                            _buffer.push_back(HEX_DIGITS[static_cast<kstd::u8>(character) & 0xF]);
+                            break;
+                        }
+
+                        _buffer.push_back(character);
+                        break;
+                }
+            }
+
+            _buffer.push_back('"');
+        }
+
+        public:
+
+        /**
+         * @param buffer The buffer to write to, it is cleared but keeps its capacity.
+         */
+        explicit JsonWriter(std::string& buffer) noexcept:
+                _buffer(buffer),
+                _has_members(),
+                _depth(0),
+                _is_after_key(false) {
+            _buffer.clear();
+        }
+
+        inline auto begin_object() noexcept -> JsonWriter& {
+            return open('{');
+        }
+
+        inline auto end_object() noexcept -> JsonWriter& {
+            return close('}');
+        }
+
+        inline auto begin_array() noexcept -> JsonWriter& {
+            return open('[');
+        }
+
+        inline auto end_array() noexcept -> JsonWriter& {
+            return close(']');
+        }
+
+        inline auto key(std::string_view name) noexcept -> JsonWriter& {
+            separate();
+            write_string(name);
+            _buffer.push_back(':');
+            _is_after_key = true;
+            return *this;
+        }
+
+        inline auto value(std::string_view value) noexcept -> JsonWriter& {
+            separate();
+            write_string(value);
+            return *this;
+        }
+
+        inline auto value(const char* value) noexcept -> JsonWriter& {
+            return this->value(std::string_view(value));
+        }
+
+        inline auto value(bool value) noexcept -> JsonWriter& {
+            separate();
+            _buffer.append(value ? "true" : "false");
+            return *this;
+        }
+
+        template<typename T>
+        requires(std::integral<T> && !std::same_as<T, bool>)
+        inline auto value(T value) noexcept -> JsonWriter& {
+            separate();
+            std::array<char, 24> digits{};
+            const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+            _buffer.append(digits.data(), result.ptr);
+            return *this;
+        }
+
+        // Enums are written as their underlying value, like nlohmann::json does
+        template<typename T>
+        requires(std::is_enum_v<T>)
+        inline auto value(T value) noexcept -> JsonWriter& {
+            return this->value(static_cast<std::underlying_type_t<T>>(value));
+        }
+
+        template<typename T>
+        inline auto field(std::string_view name, T value) noexcept -> JsonWriter& {
+            return key(name).value(value);
+        }
+
+        [[nodiscard]] inline auto get_view() const noexcept -> std::string_view {
+            return _buffer;
+        }
+    };
+
+    /**
+     * @return A buffer owned by the calling thread, meant to be handed to a JsonWriter.
+     */
+    [[nodiscard]] inline auto get_thread_json_buffer() noexcept -> std::string& {
+        thread_local std::string buffer;
+        return buffer;
+    }
+}
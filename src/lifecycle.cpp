@@ -0,0 +1,96 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <spdlog/spdlog.h>
+#include <kstd/platform/platform.hpp>
+#include "lifecycle.hpp"
+
+namespace fox {
+    Lifecycle::Lifecycle() :
+            _previous_signals(),
+            _signal_handle(-1),
+            _wakeup_handle(::eventfd(0, EFD_CLOEXEC)),
+            _signal_thread(),
+            _shutdown(),
+            _reason(nullptr) {
+        sigset_t signals{};
+        ::sigemptyset(&signals);
+        ::sigaddset(&signals, SIGINT);
+        ::sigaddset(&signals, SIGTERM);
+
+        if (::pthread_sigmask(SIG_BLOCK, &signals, &_previous_signals) != 0) {
+            throw std::runtime_error("Could not block shutdown signals");
+        }
+
+        _signal_handle = ::signalfd(-1, &signals, SFD_CLOEXEC);
+
+        if (_signal_handle == -1 || _wakeup_handle == -1) {
+            throw std::runtime_error(fmt::format("Could not create lifecycle handles: {}", kstd::platform::get_last_error()));
+        }
+
+        _signal_thread = std::thread(signal_loop, this);
+    }
+
+    Lifecycle::~Lifecycle() noexcept {
+        const kstd::u64 value = 1;
+        [[maybe_unused]] const auto result = ::write(_wakeup_handle, &value, sizeof(value));
+        _signal_thread.join();
+
+        ::close(_signal_handle);
+        ::close(_wakeup_handle);
+
+        // Signals are handled the default way again, instead of being ignored forever
+        ::pthread_sigmask(SIG_SETMASK, &_previous_signals, nullptr);
+    }
+
+    auto Lifecycle::request_shutdown(const char* reason) noexcept -> void {
+        const char* expected = nullptr;
+
+        if (_reason.compare_exchange_strong(expected, reason)) {
+            spdlog::info("Shutdown requested: {}", reason);
+        }
+
+        _shutdown.set();
+    }
+
+    auto Lifecycle::signal_loop(Lifecycle* self) noexcept -> void {
+        std::array<pollfd, 2> handles{{
+            {self->_signal_handle, POLLIN, 0},
+            {self->_wakeup_handle, POLLIN, 0}
+        }};
+
+        while (true) {
+            if (::poll(handles.data(), handles.size(), -1) == -1) {
+                continue; // Interrupted
+            }
+
+            if ((handles[1].revents & POLLIN) != 0) {
+                return;
+            }
+
+            signalfd_siginfo info{};
+
+            if (::read(self->_signal_handle, &info, sizeof(info)) != sizeof(info)) {
+                continue;
+            }
+
+            if (self->is_shutdown_requested()) {
+                spdlog::warn("Received signal {} while shutting down, exiting immediately", info.ssi_signo);
+                std::_Exit(1);
+            }
+
+            self->request_shutdown(info.ssi_signo == SIGINT ? "interrupted" : "terminated");
+        }
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <csignal>
+#include <utility>
+#include <condition_variable>
+#include <kstd/types.hpp>
+
+namespace fox {
+    constexpr std::chrono::milliseconds THREAD_JOIN_TIMEOUT(2000);
+
+    /**
+     * One-shot flag other threads can block on until it is set.
+     */
+    class Latch final {
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _is_set;
+
+        public:
+
+        Latch() noexcept:
+                _mutex(),
+                _condition(),
+                _is_set(false) {
+        }
+
+        /**
+         * @return False if the latch was already set.
+         */
+        inline auto set() noexcept -> bool {
+            {
+                std::scoped_lock lock(_mutex);
+
+                if (_is_set) {
+                    return false;
+                }
+
+                _is_set = true;
+            }
+
+            _condition.notify_all();
+            return true;
+        }
+
+        inline auto wait() noexcept -> void {
+            std::unique_lock lock(_mutex);
+            _condition.wait(lock, [this] {
+                return _is_set;
+            });
+        }
+
+        /**
+         * @return False if the timeout ran out before the latch was set.
+         */
+        inline auto wait_for(std::chrono::milliseconds timeout) noexcept -> bool {
+            std::unique_lock lock(_mutex);
+            return _condition.wait_for(lock, timeout, [this] {
+                return _is_set;
+            });
+        }
+
+        [[nodiscard]] inline auto is_set() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            return _is_set;
+        }
+    };
+
+    /**
+     * Thread which can be joined with a timeout, so its owner can interrupt
+     * whatever the worker is blocked in again between attempts. The thread
+     * is never detached, workers use their owner until they return.
+     */
+    class BoundedThread final {
+        std::thread _thread;
+        Latch _exited;
+
+        public:
+
+        BoundedThread() noexcept:
+                _thread(),
+                _exited() {
+        }
+
+        BoundedThread(const BoundedThread& other) = delete;
+
+        BoundedThread(BoundedThread&& other) = delete;
+
+        ~BoundedThread() noexcept {
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        auto operator =(const BoundedThread& other) -> BoundedThread& = delete;
+
+        auto operator =(BoundedThread&& other) -> BoundedThread& = delete;
+
+        template<typename F>
+        inline auto start(F&& function) -> void {
+            _thread = std::thread([this, function = std::forward<F>(function)]() mutable {
+                function();
+                _exited.set();
+            });
+        }
+
+        /**
+         * @return False if the thread did not finish in time, it is still running then.
+         */
+        inline auto join_for(std::chrono::milliseconds timeout) noexcept -> bool {
+            if (!_thread.joinable()) {
+                return true;
+            }
+
+            if (!_exited.wait_for(timeout)) {
+                return false;
+            }
+
+            _thread.join();
+            return true;
+        }
+
+        /**
+         * Gives up on a thread which could not be interrupted. It can't be left
+         * running on its owner while that is destroyed, so the process exits.
+         */
+        [[noreturn]] static inline auto abandon() noexcept -> void {
+            std::_Exit(1);
+        }
+
+        [[nodiscard]] inline auto is_started() const noexcept -> bool {
+            return _thread.joinable();
+        }
+    };
+
+    /**
+     * Coordinates the shutdown of the process. SIGINT and SIGTERM are blocked
+     * for every thread and received through a signalfd on a dedicated thread
+     * instead, so they can never interrupt a worker halfway through a write.
+     * Any component may request the shutdown, main waits for it without
+     * burning any CPU time and then tears everything down in order.
+     * A second signal while shutting down exits the process immediately.
+     *
+     * Has to be created before any other thread, as the signal mask is inherited.
+     * The previous mask of the creating thread is restored on destruction.
+     */
+    class Lifecycle final {
+        sigset_t _previous_signals;
+        kstd::i32 _signal_handle;
+        kstd::i32 _wakeup_handle;
+        std::thread _signal_thread;
+        Latch _shutdown;
+        std::atomic<const char*> _reason;
+
+        static auto signal_loop(Lifecycle* self) noexcept -> void;
+
+        public:
+
+        Lifecycle();
+
+        Lifecycle(const Lifecycle& other) = delete;
+
+        Lifecycle(Lifecycle&& other) = delete;
+
+        ~Lifecycle() noexcept;
+
+        auto operator =(const Lifecycle& other) -> Lifecycle& = delete;
+
+        auto operator =(Lifecycle&& other) -> Lifecycle& = delete;
+
+        /**
+         * Releases everyone waiting for the shutdown, safe to call from any thread.
+         * @param reason Static description of the cause, only the first one is kept.
+         */
+        auto request_shutdown(const char* reason) noexcept -> void;
+
+        inline auto wait() noexcept -> void {
+            _shutdown.wait();
+        }
+
+        [[nodiscard]] inline auto is_shutdown_requested() const noexcept -> bool {
+            return _reason.load() != nullptr;
+        }
+
+        [[nodiscard]] inline auto get_reason() const noexcept -> const char* {
+            const auto* reason = _reason.load();
+            return reason == nullptr ? "" : reason;
+        }
+    };
+}
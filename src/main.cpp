@@ -4,6 +4,7 @@
  */
 
 #include <string>
+#include <optional>
 #include <iostream>
 
 #include <cxxopts/cxxopts.hpp>
@@ -14,6 +15,8 @@
 #include "server.hpp"
 #include "monitor.hpp"
 #include "gateway.hpp"
+#include "control_endpoint.hpp"
+#include "lifecycle.hpp"
 
 auto main(int num_args, char** args) -> int {
     spdlog::set_default_logger(spdlog::create<spdlog::sinks::stdout_color_sink_mt>("FoxControl"));
@@ -26,12 +29,23 @@ auto main(int num_args, char** args) -> int {
     option_spec.add_options()
        ("h,help", "Show this help dialog")
        ("d,device", "Specify the serial device to connect to", cxxopts::value<std::string>())
-       ("r,rate", "Specify the serial IO baud rate", cxxopts::value<kstd::u32>()->default_value("19200"))
+       ("r,rate", "Specify the serial IO baud rate (standard rates up to 4000000 or any rate the driver supports)", cxxopts::value<kstd::u32>()->default_value("19200"))
+       ("t,txinterval", "Specify the time in microseconds the device needs to process a single command", cxxopts::value<kstd::u32>()->default_value("1000"))
+       ("b,txburst", "Specify the number of commands the device can buffer", cxxopts::value<kstd::u32>()->default_value("16"))
+       ("w,window", "Specify the number of unacknowledged commands allowed in flight (0 for unlimited)", cxxopts::value<kstd::u32>()->default_value("16"))
+       ("k,acktimeout", "Specify the time in milliseconds after which an unacknowledged command is considered lost", cxxopts::value<kstd::u32>()->default_value("500"))
+       ("R,retransmits", "Specify how often a lost command is sent again", cxxopts::value<kstd::u32>()->default_value("0"))
+       ("B,binary", "Negotiate the framed binary protocol with the device, falling back to the char protocol")
        ("a,address", "Specify the address of the HTTP gateway to connect to", cxxopts::value<std::string>())
        ("p,port", "Specify the port of the HTTP gateway to connect to", cxxopts::value<kstd::u32>()->default_value("443"))
        ("u,updaterate", "Specify the gateway fetch rate in milliseconds", cxxopts::value<kstd::u32>()->default_value("500"))
+       ("i,idlerate", "Specify the slowest gateway fetch rate in milliseconds, backed off to while idle", cxxopts::value<kstd::u32>()->default_value("2000"))
+       ("T,transport", "Specify how tasks are received from the gateway (poll, longpoll or stream)", cxxopts::value<std::string>()->default_value("longpoll"))
+       ("W,wireformat", "Specify the body encoding used with the gateway (json, cbor or msgpack), falling back to json", cxxopts::value<std::string>()->default_value("json"))
        ("c,certificate", "Specify the X509 certificate to use for gateway requests", cxxopts::value<std::string>()->default_value("./certificate.crt"))
        ("P,password", "Specify the password with which to authenticate against the gateway", cxxopts::value<std::string>())
+       ("l,localaddress", "Specify the address on which to serve the local control endpoint", cxxopts::value<std::string>()->default_value("127.0.0.1"))
+       ("L,localport", "Specify the port of the local control endpoint (0 to disable it)", cxxopts::value<kstd::u32>()->default_value("0"))
        ("m,monitor", "Open the local monitor UI (Requires OpenGL 3.3)")
        ("V,verbose", "Enable verbose logging")
        ("v,version", "Show version information");
@@ -64,17 +78,50 @@ auto main(int num_args, char** args) -> int {
 
     const auto device = options["device"].as<std::string>();
     const auto baud_rate = options["rate"].as<kstd::u32>();
-    fox::Server server(device, baud_rate);
+    const fox::serial::PacingPolicy pacing{
+        std::chrono::microseconds(options["txinterval"].as<kstd::u32>()),
+        options["txburst"].as<kstd::u32>()
+    };
+    const fox::serial::FlowControlPolicy flow_control{
+        options["window"].as<kstd::u32>(),
+        std::chrono::milliseconds(options["acktimeout"].as<kstd::u32>()),
+        options["retransmits"].as<kstd::u32>()
+    };
+    // Blocks the shutdown signals, so it has to exist before any other thread is started
+    fox::Lifecycle lifecycle;
+    fox::Server server(lifecycle, device, baud_rate, pacing, flow_control, options.count("binary") > 0, true);
 
     const auto gateway_address = options["address"].as<std::string>();
     const auto gateway_port = options["port"].as<kstd::u32>();
     const auto gateway_rate = options["updaterate"].as<kstd::u32>();
+    const auto gateway_idle_rate = options["idlerate"].as<kstd::u32>();
     const auto gateway_cert = options["certificate"].as<std::string>();
     const auto gateway_pass = options["password"].as<std::string>();
-    fox::Gateway gateway(server, gateway_address, gateway_port, gateway_rate, gateway_cert, gateway_pass);
+    const auto gateway_transport = fox::parse_transport(options["transport"].as<std::string>());
+
+    if (!gateway_transport) {
+        spdlog::error("Unknown gateway transport {}", options["transport"].as<std::string>());
+        return 1;
+    }
+
+    const auto gateway_wire_format = fox::parse_wire_format(options["wireformat"].as<std::string>());
+
+    if (!gateway_wire_format) {
+        spdlog::error("Unknown gateway wire format {}", options["wireformat"].as<std::string>());
+        return 1;
+    }
+
+    fox::Gateway gateway(server, gateway_address, gateway_port, gateway_rate, gateway_idle_rate, *gateway_transport, *gateway_wire_format, gateway_cert, gateway_pass);
+
+    // Shares the gateway password, so only clients which could drive the device through the gateway get in
+    std::optional<fox::ControlEndpoint> control_endpoint;
+
+    if (const auto local_port = options["localport"].as<kstd::u32>(); local_port != 0) {
+        control_endpoint.emplace(server, options["localaddress"].as<std::string>(), local_port, gateway_pass);
+    }
 
     if (options.count("monitor") > 0) {
-        fox::Monitor monitor(server, gateway);
+        fox::Monitor monitor(server, gateway, lifecycle);
 
         if (const auto result = monitor.run(); !result.has_value()) {
             spdlog::error(result.error());
@@ -82,9 +129,16 @@ auto main(int num_args, char** args) -> int {
         }
     }
 
-    while (server.is_running()) {
-        std::this_thread::yield(); // Wait until server terminates
+    lifecycle.wait();
+
+    // Stop taking local tasks first, then power the device off while the gateway
+    // can still publish the final state, the gateway reports going offline next
+    control_endpoint.reset();
+
+    if (!server.shutdown(fox::SHUTDOWN_DRAIN_TIMEOUT)) {
+        spdlog::warn("Device did not acknowledge all commands before shutting down");
     }
 
+    spdlog::info("Shutting down gracefully");
     return 0;
 }
\ No newline at end of file
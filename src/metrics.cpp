@@ -0,0 +1,66 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include "metrics.hpp"
+
+namespace fox {
+    /**
+     * Head of the list of registered metrics. Constant initialized, so metrics
+     * may register from the static initializers of any translation unit.
+     */
+    static auto get_metric_list() noexcept -> std::atomic<Metric*>& {
+        static std::atomic<Metric*> head(nullptr);
+        return head;
+    }
+
+    auto get_metric_shard() noexcept -> kstd::usize {
+        static std::atomic<kstd::usize> next_shard(0);
+        thread_local const auto shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_METRIC_SHARDS;
+        return shard;
+    }
+
+    Metric::Metric(const char* name, const char* help) noexcept:
+            _name(name),
+            _help(help),
+            _next(nullptr) {
+        auto& head = get_metric_list();
+        _next = head.load(std::memory_order_relaxed);
+
+        while (!head.compare_exchange_weak(_next, this, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    auto Counter::write_samples(std::string& buffer) const noexcept -> void {
+        fmt::format_to(std::back_inserter(buffer), "{} {}\n", get_name(), get());
+    }
+
+    auto Counter::write_summary(std::string& buffer) const noexcept -> void {
+        fmt::format_to(std::back_inserter(buffer), "{}: {}", get_name(), get());
+    }
+
+    auto Gauge::write_samples(std::string& buffer) const noexcept -> void {
+        fmt::format_to(std::back_inserter(buffer), "{} {}\n", get_name(), get());
+    }
+
+    auto Gauge::write_summary(std::string& buffer) const noexcept -> void {
+        fmt::format_to(std::back_inserter(buffer), "{}: {}", get_name(), get());
+    }
+
+    auto write_metrics(std::string& buffer) noexcept -> void {
+        auto output = std::back_inserter(buffer);
+
+        for (const auto* metric = get_metric_list().load(std::memory_order_acquire); metric != nullptr; metric = metric->_next) {
+            fmt::format_to(output, "# HELP {} {}\n# TYPE {} {}\n", metric->_name, metric->_help, metric->_name, metric->get_type());
+            metric->write_samples(buffer);
+        }
+    }
+
+    auto write_metric_summary(std::string& buffer) noexcept -> void {
+        for (const auto* metric = get_metric_list().load(std::memory_order_acquire); metric != nullptr; metric = metric->_next) {
+            metric->write_summary(buffer);
+            buffer.push_back('\n');
+        }
+    }
+}
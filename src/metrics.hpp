@@ -0,0 +1,326 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <iterator>
+#include <algorithm>
+#include <fmt/format.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    constexpr kstd::usize NUM_METRIC_SHARDS = 8; // Threads beyond this share shards, which only costs some contention
+    constexpr kstd::usize CACHE_LINE_SIZE = 64;
+
+    /**
+     * @return The shard the calling thread records into, assigned round robin on first use.
+     */
+    [[nodiscard]] auto get_metric_shard() noexcept -> kstd::usize;
+
+    /**
+     * Base of all metrics. Every metric registers itself in a global lock-free
+     * list on construction, so metrics are meant to be defined once with static
+     * storage duration (see the fox::metrics namespace below) and never destroyed
+     * while other threads may still record into them.
+     */
+    class Metric {
+        const char* _name;
+        const char* _help;
+        Metric* _next;
+
+        friend auto write_metrics(std::string& buffer) noexcept -> void;
+
+        friend auto write_metric_summary(std::string& buffer) noexcept -> void;
+
+        protected:
+
+        Metric(const char* name, const char* help) noexcept;
+
+        ~Metric() noexcept = default;
+
+        public:
+
+        Metric(const Metric& other) = delete;
+
+        Metric(Metric&& other) = delete;
+
+        auto operator =(const Metric& other) -> Metric& = delete;
+
+        auto operator =(Metric&& other) -> Metric& = delete;
+
+        [[nodiscard]] virtual auto get_type() const noexcept -> const char* = 0;
+
+        /**
+         * Appends the samples of this metric in the Prometheus text format.
+         */
+        virtual auto write_samples(std::string& buffer) const noexcept -> void = 0;
+
+        /**
+         * Appends a short human readable line without a line break.
+         */
+        virtual auto write_summary(std::string& buffer) const noexcept -> void = 0;
+
+        [[nodiscard]] inline auto get_name() const noexcept -> const char* {
+            return _name;
+        }
+
+        [[nodiscard]] inline auto get_help() const noexcept -> const char* {
+            return _help;
+        }
+    };
+
+    /**
+     * Monotonic counter, recorded into per-thread shards so hot paths on
+     * different threads never contend on the same cache line.
+     */
+    class Counter final : public Metric {
+        struct alignas(CACHE_LINE_SIZE) Shard final {
+            std::atomic_uint64_t value;
+        };
+
+        std::array<Shard, NUM_METRIC_SHARDS> _shards;
+
+        public:
+
+        Counter(const char* name, const char* help) noexcept:
+                Metric(name, help),
+                _shards() {
+        }
+
+        inline auto add(kstd::u64 value = 1) noexcept -> void {
+            _shards[get_metric_shard()].value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get() const noexcept -> kstd::u64 {
+            kstd::u64 total = 0;
+
+            for (const auto& shard: _shards) {
+                total += shard.value.load(std::memory_order_relaxed);
+            }
+
+            return total;
+        }
+
+        [[nodiscard]] auto get_type() const noexcept -> const char* override {
+            return "counter";
+        }
+
+        auto write_samples(std::string& buffer) const noexcept -> void override;
+
+        auto write_summary(std::string& buffer) const noexcept -> void override;
+    };
+
+    /**
+     * Value which can go up and down, there is only ever one current value so it isn't sharded.
+     */
+    class Gauge final : public Metric {
+        std::atomic_int64_t _value;
+
+        public:
+
+        Gauge(const char* name, const char* help) noexcept:
+                Metric(name, help),
+                _value(0) {
+        }
+
+        inline auto set(kstd::i64 value) noexcept -> void {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        inline auto add(kstd::i64 value) noexcept -> void {
+            _value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get() const noexcept -> kstd::i64 {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] auto get_type() const noexcept -> const char* override {
+            return "gauge";
+        }
+
+        auto write_samples(std::string& buffer) const noexcept -> void override;
+
+        auto write_summary(std::string& buffer) const noexcept -> void override;
+    };
+
+    /**
+     * Histogram of durations with fixed bucket bounds in microseconds,
+     * exposed in seconds as Prometheus expects.
+     */
+    template<kstd::usize N>
+    class Histogram final : public Metric {
+        struct alignas(CACHE_LINE_SIZE) Shard final {
+            std::array<std::atomic_uint64_t, N + 1> buckets; // The last bucket catches everything above the largest bound
+            std::atomic_uint64_t count;
+            std::atomic_uint64_t sum;
+        };
+
+        std::array<kstd::u64, N> _bounds;
+        std::array<Shard, NUM_METRIC_SHARDS> _shards;
+
+        /**
+         * @return The number of samples per bucket, summed over all shards but not yet cumulative.
+         */
+        [[nodiscard]] inline auto get_bucket_counts() const noexcept -> std::array<kstd::u64, N + 1> {
+            std::array<kstd::u64, N + 1> counts{};
+
+            for (const auto& shard: _shards) {
+                for (kstd::usize index = 0; index <= N; ++index) {
+                    counts[index] += shard.buckets[index].load(std::memory_order_relaxed);
+                }
+            }
+
+            return counts;
+        }
+
+        public:
+
+        Histogram(const char* name, const char* help, const std::array<kstd::u64, N>& bounds) noexcept:
+                Metric(name, help),
+                _bounds(bounds),
+                _shards() {
+        }
+
+        inline auto observe(std::chrono::nanoseconds duration) noexcept -> void {
+            const auto value = static_cast<kstd::u64>(std::max<kstd::i64>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0));
+            kstd::usize index = 0;
+
+            while (index < N && value > _bounds[index]) {
+                ++index;
+            }
+
+            auto& shard = _shards[get_metric_shard()];
+            shard.buckets[index].fetch_add(1, std::memory_order_relaxed);
+            shard.count.fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get_count() const noexcept -> kstd::u64 {
+            kstd::u64 total = 0;
+
+            for (const auto& shard: _shards) {
+                total += shard.count.load(std::memory_order_relaxed);
+            }
+
+            return total;
+        }
+
+        [[nodiscard]] inline auto get_sum() const noexcept -> std::chrono::microseconds {
+            kstd::u64 total = 0;
+
+            for (const auto& shard: _shards) {
+                total += shard.sum.load(std::memory_order_relaxed);
+            }
+
+            return std::chrono::microseconds(total);
+        }
+
+        /**
+         * @return The upper bound of the bucket containing the given quantile, the largest bound if it lies above all of them.
+         */
+        [[nodiscard]] inline auto get_quantile_bound(kstd::f64 quantile) const noexcept -> std::chrono::microseconds {
+            const auto counts = get_bucket_counts();
+            kstd::u64 total = 0;
+
+            for (const auto count: counts) {
+                total += count;
+            }
+
+            if (total == 0) {
+                return std::chrono::microseconds::zero();
+            }
+
+            const auto rank = static_cast<kstd::u64>(quantile * static_cast<kstd::f64>(total));
+            kstd::u64 seen = 0;
+
+            for (kstd::usize index = 0; index < N; ++index) {
+                seen += counts[index];
+
+                if (seen > rank) {
+                    return std::chrono::microseconds(_bounds[index]);
+                }
+            }
+
+            return std::chrono::microseconds(_bounds[N - 1]);
+        }
+
+        [[nodiscard]] auto get_type() const noexcept -> const char* override {
+            return "histogram";
+        }
+
+        auto write_samples(std::string& buffer) const noexcept -> void override;
+
+        auto write_summary(std::string& buffer) const noexcept -> void override;
+    };
+
+    template<kstd::usize N>
+    Histogram(const char* name, const char* help, const std::array<kstd::u64, N>& bounds) -> Histogram<N>;
+
+    template<kstd::usize N>
+    auto Histogram<N>::write_samples(std::string& buffer) const noexcept -> void {
+        const auto counts = get_bucket_counts();
+        auto output = std::back_inserter(buffer);
+        kstd::u64 cumulative = 0;
+
+        for (kstd::usize index = 0; index < N; ++index) {
+            cumulative += counts[index];
+            fmt::format_to(output, "{}_bucket{{le=\"{}\"}} {}\n", get_name(), static_cast<kstd::f64>(_bounds[index]) / 1e6, cumulative);
+        }
+
+        // The count is derived from the buckets, so a scrape racing with observe() stays consistent
+        cumulative += counts[N];
+        fmt::format_to(output, "{}_bucket{{le=\"+Inf\"}} {}\n", get_name(), cumulative);
+        fmt::format_to(output, "{}_sum {}\n", get_name(), static_cast<kstd::f64>(get_sum().count()) / 1e6);
+        fmt::format_to(output, "{}_count {}\n", get_name(), cumulative);
+    }
+
+    template<kstd::usize N>
+    auto Histogram<N>::write_summary(std::string& buffer) const noexcept -> void {
+        const auto count = get_count();
+        const auto mean = count == 0 ? 0.0 : static_cast<kstd::f64>(get_sum().count()) / static_cast<kstd::f64>(count) / 1000.0;
+        fmt::format_to(std::back_inserter(buffer), "{}: {} samples, mean {:.2f}ms, p50 <= {}ms, p99 <= {}ms", get_name(), count, mean,
+            static_cast<kstd::f64>(get_quantile_bound(0.5).count()) / 1000.0, static_cast<kstd::f64>(get_quantile_bound(0.99).count()) / 1000.0);
+    }
+
+    /**
+     * Appends all registered metrics in the Prometheus text exposition format.
+     */
+    auto write_metrics(std::string& buffer) noexcept -> void;
+
+    /**
+     * Appends one summary line per registered metric, for the console.
+     */
+    auto write_metric_summary(std::string& buffer) noexcept -> void;
+
+    namespace metrics {
+        // Bucket bounds in microseconds
+        constexpr std::array<kstd::u64, 11> ROUND_TRIP_BUCKETS{500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+        constexpr std::array<kstd::u64, 12> REQUEST_BUCKETS{5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 30000000};
+        constexpr std::array<kstd::u64, 10> SETTLE_BUCKETS{10000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 30000000};
+
+        inline Counter serial_tx_bytes("fox_serial_tx_bytes_total", "Bytes written to the serial device");
+        inline Counter serial_rx_bytes("fox_serial_rx_bytes_total", "Bytes read from the serial device");
+        inline Counter serial_commands_sent("fox_serial_commands_sent_total", "Commands planned and sent to the device, without retransmissions");
+        inline Counter serial_retransmits("fox_serial_retransmits_total", "Commands sent again after their acknowledgement timed out");
+        inline Counter serial_commands_lost("fox_serial_commands_lost_total", "Commands given up on after all retransmissions");
+        inline Gauge serial_in_flight("fox_serial_commands_in_flight", "Commands waiting for their acknowledgement");
+        inline Gauge tx_queue_depth("fox_tx_queue_depth", "Commands waiting in the TX queue for the serial IO thread");
+        inline Histogram serial_round_trip("fox_serial_round_trip_seconds", "Time between sending a command and its acknowledgement", ROUND_TRIP_BUCKETS);
+        inline Histogram device_settle("fox_device_settle_seconds", "Time the device takes to reach a new target speed", SETTLE_BUCKETS);
+
+        inline Counter tasks_received("fox_tasks_received_total", "Valid tasks received from the gateway and the local endpoint");
+        inline Counter tasks_applied("fox_tasks_applied_total", "Tasks applied after collapsing each batch into its net change");
+
+        inline Counter gateway_requests("fox_gateway_requests_total", "Requests sent to the gateway");
+        inline Counter gateway_errors("fox_gateway_errors_total", "Gateway requests which failed or were not answered with 200");
+        inline Counter gateway_setstate_failures("fox_gateway_setstate_failures_total", "State updates which could not be published");
+        inline Histogram gateway_fetch("fox_gateway_fetch_seconds", "Round trip time of task fetches, including the time a long poll is held", REQUEST_BUCKETS);
+    }
+}
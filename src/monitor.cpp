@@ -7,7 +7,6 @@
 #include <SDL_rwops.h>
 #include <SDL_video.h>
 #include <SDL_image.h>
-#include <SDL_messagebox.h>
 #include <SDL_clipboard.h>
 #include <glad/gl.h>
 #include <imgui/imgui.h>
@@ -18,12 +17,14 @@
 #include "monitor.hpp"
 #include "server.hpp"
 #include "gateway.hpp"
+#include "lifecycle.hpp"
 #include "imgui_utils.hpp"
 
 namespace fox {
-    Monitor::Monitor(Server& server, Gateway& gateway) noexcept:
+    Monitor::Monitor(Server& server, Gateway& gateway, Lifecycle& lifecycle) noexcept:
             _server(server),
             _gateway(gateway),
+            _lifecycle(lifecycle),
             _render_tasks(),
             _is_running(true),
             _is_close_requested(false),
@@ -106,7 +107,7 @@ namespace fox {
                 handle_event(window, event);
             }
 
-            if (_is_close_requested) {
+            if (_is_close_requested || _lifecycle.is_shutdown_requested()) {
                 _is_running = false;
                 _is_close_requested = false;
                 spdlog::info("Requesting window close");
@@ -270,6 +271,12 @@ namespace fox {
         ImGui::SameLine();
         ImGui::Text("Session Password: %s", _session_display_password.c_str());
 
+        const auto connection_stats = _gateway.get_connection_stats();
+        ImGui::Text("Gateway: %s, %s, %u handshakes/min (%llu of %llu resumed)", _gateway.is_healthy() ? "Healthy" : "Reconnecting", get_wire_format_name(_gateway.get_wire_format()), connection_stats.handshakes_per_minute, static_cast<unsigned long long>(connection_stats.num_resumed_handshakes), static_cast<unsigned long long>(connection_stats.num_handshakes));
+
+        const auto circuit_stats = _gateway.get_circuit_stats();
+        ImGui::Text("Circuit: %s, %llu trips, %llu rejected, %llu retries", get_circuit_state_name(circuit_stats.state), static_cast<unsigned long long>(circuit_stats.num_trips), static_cast<unsigned long long>(circuit_stats.num_rejected), static_cast<unsigned long long>(_gateway.get_num_retries()));
+
         ImGui::Separator();
         ImGui::Text("Controls");
 
@@ -301,14 +308,15 @@ namespace fox {
 
         ImGui::Text("Target Speed: %d", _server.get_target_speed());
         ImGui::Text("Actual Speed: %d", _server.get_actual_speed());
-        ImGui::PlotLines("Speed History", _speed_history.data(), NUM_SPEED_HISTORY_ENTRIES, 0, nullptr, static_cast<kstd::f32>(MIN_SPEED), static_cast<kstd::f32>(MAX_SPEED), {0, 120.0F});
-        ImGui::PlotHistogram("Speed Delta", _speed_delta_history.data(), NUM_SPEED_HISTORY_ENTRIES, 0, nullptr, static_cast<kstd::f32>(MIN_SPEED), static_cast<kstd::f32>(MAX_SPEED), {0, 120.0F});
+        ImGui::Text("Round Trip Time: %.2fms", static_cast<kstd::f32>(_server.get_round_trip_time().count()) / 1000.0F);
+        ImGui::PlotLines("Speed History", _speed_history.data(), NUM_SPEED_HISTORY_ENTRIES, 0, nullptr, static_cast<kstd::f32>(dto::MIN_SPEED), static_cast<kstd::f32>(dto::MAX_SPEED), {0, 120.0F});
+        ImGui::PlotHistogram("Speed Delta", _speed_delta_history.data(), NUM_SPEED_HISTORY_ENTRIES, 0, nullptr, static_cast<kstd::f32>(dto::MIN_SPEED), static_cast<kstd::f32>(dto::MAX_SPEED), {0, 120.0F});
 
         if (cannot_change_state) {
             imgui::push_disabled();
         }
 
-        ImGui::SliderInt("Speed", &_current_slider_speed, MIN_SPEED, MAX_SPEED);
+        ImGui::SliderInt("Speed", &_current_slider_speed, dto::MIN_SPEED, dto::MAX_SPEED);
 
         if (cannot_change_state) {
             imgui::pop_disabled();
@@ -372,7 +380,7 @@ namespace fox {
                 }
                 break;
             case SDL_QUIT:
-                SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Wanna quit?", "If you want to quit the application, enter 'exit' into the system console", nullptr);
+                _lifecycle.request_shutdown("monitor closed");
                 break;
         }
     }
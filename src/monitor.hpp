@@ -27,10 +27,13 @@ namespace fox
 
     class Gateway;
 
+    class Lifecycle;
+
     class Monitor final
     {
         Server& _server;
         Gateway& _gateway;
+        Lifecycle& _lifecycle;
 
         std::queue<std::function<void()>> _render_tasks;
         std::mutex _task_queue_mutex;
@@ -99,7 +102,7 @@ namespace fox
         }
 
     public:
-        Monitor(Server& server, Gateway& gateway) noexcept;
+        Monitor(Server& server, Gateway& gateway, Lifecycle& lifecycle) noexcept;
 
         ~Monitor() noexcept = default;
 
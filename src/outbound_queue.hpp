@@ -0,0 +1,138 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <optional>
+#include <algorithm>
+#include <condition_variable>
+#include <kstd/types.hpp>
+
+namespace fox {
+    enum class Outbound : kstd::u8 {
+        ONLINE,
+        OFFLINE,
+        SESSION,
+        STATE
+    };
+
+    /**
+     * Bounded queue of requests for the gateway publisher. State updates carry
+     * no payload since the publisher takes a snapshot when sending, so at most
+     * one of them is ever queued and stale updates collapse into it.
+     *
+     * The publisher peeks at the head and only removes it once it was sent,
+     * so a message which failed is retried before anything queued after it.
+     */
+    template<kstd::usize CAPACITY>
+    class OutboundQueue final {
+        std::deque<Outbound> _messages;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _is_closed;
+        bool _is_head_in_flight; // The head is being sent, so later pushes must not collapse into it
+
+        /**
+         * @return True if the message is queued and not being sent yet.
+         */
+        [[nodiscard]] inline auto is_waiting(Outbound message) const noexcept -> bool {
+            const auto begin = _is_head_in_flight && !_messages.empty() ? _messages.begin() + 1 : _messages.begin();
+            return std::find(begin, _messages.end(), message) != _messages.end();
+        }
+
+        inline auto enqueue(Outbound message, bool is_unique) noexcept -> bool {
+            {
+                std::scoped_lock lock(_mutex);
+
+                if (_is_closed) {
+                    return false;
+                }
+
+                if ((is_unique || message == Outbound::STATE) && is_waiting(message)) {
+                    return true;
+                }
+
+                if (_messages.size() >= CAPACITY) {
+                    return false;
+                }
+
+                _messages.push_back(message);
+            }
+
+            _condition.notify_one();
+            return true;
+        }
+
+        public:
+
+        OutboundQueue() noexcept:
+                _messages(),
+                _mutex(),
+                _condition(),
+                _is_closed(false),
+                _is_head_in_flight(false) {
+        }
+
+        /**
+         * @return False if the queue is full or closed.
+         */
+        inline auto push(Outbound message) noexcept -> bool {
+            return enqueue(message, false);
+        }
+
+        /**
+         * Like push, but does nothing if the same message is already waiting to be sent.
+         */
+        inline auto push_unique(Outbound message) noexcept -> bool {
+            return enqueue(message, true);
+        }
+
+        /**
+         * Waits for the next message and marks it as being sent, without removing it.
+         * @return The message, or std::nullopt if the timeout expired or the queue was closed.
+         */
+        template<typename R, typename P>
+        inline auto peek(std::chrono::duration<R, P> timeout) noexcept -> std::optional<Outbound> {
+            std::unique_lock lock(_mutex);
+
+            if (!_condition.wait_for(lock, timeout, [this] { return _is_closed || !_messages.empty(); }) || _is_closed) {
+                return std::nullopt;
+            }
+
+            _is_head_in_flight = true;
+            return _messages.front();
+        }
+
+        /**
+         * Removes the message returned by the last peek, once it was sent.
+         */
+        inline auto pop() noexcept -> void {
+            std::scoped_lock lock(_mutex);
+
+            if (_is_head_in_flight && !_messages.empty()) {
+                _messages.pop_front();
+            }
+
+            _is_head_in_flight = false;
+        }
+
+        inline auto close() noexcept -> void {
+            {
+                std::scoped_lock lock(_mutex);
+                _is_closed = true;
+            }
+
+            _condition.notify_all();
+        }
+
+        [[nodiscard]] inline auto is_closed() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            return _is_closed;
+        }
+    };
+}
@@ -0,0 +1,67 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <kstd/types.hpp>
+
+namespace fox::serial {
+    using Clock = std::chrono::steady_clock;
+
+    struct PacingPolicy final {
+        std::chrono::microseconds message_interval; // Time the device needs to process one message
+        kstd::u32 max_burst;                        // Number of messages the device can buffer
+    };
+
+    /**
+     * Token bucket (GCRA) limiting the rate at which messages are handed to the device.
+     * The interval is never shorter than the time a single byte needs on the wire.
+     */
+    class Pacer final {
+        Clock::duration _interval;
+        Clock::duration _tolerance;
+        Clock::time_point _theoretical_arrival;
+
+        public:
+
+        Pacer(const PacingPolicy& policy, kstd::u32 baud_rate) noexcept:
+                _interval(std::max<Clock::duration>(policy.message_interval, std::chrono::microseconds((10 * 1000000 + baud_rate - 1) / baud_rate))),
+                _tolerance(_interval * (std::max<kstd::u32>(policy.max_burst, 1) - 1)),
+                _theoretical_arrival() {
+        }
+
+        /**
+         * @return The number of messages which may be sent right now.
+         */
+        [[nodiscard]] inline auto get_available(Clock::time_point now) const noexcept -> kstd::u32 {
+            const auto backlog = std::max(_theoretical_arrival, now) - now;
+
+            if (backlog > _tolerance) {
+                return 0;
+            }
+
+            return static_cast<kstd::u32>((_tolerance - backlog) / _interval) + 1;
+        }
+
+        inline auto commit(Clock::time_point now, kstd::u32 count) noexcept -> void {
+            _theoretical_arrival = std::max(_theoretical_arrival, now) + _interval * count;
+        }
+
+        /**
+         * @return The time until the next message may be sent.
+         */
+        [[nodiscard]] inline auto get_delay(Clock::time_point now) const noexcept -> Clock::duration {
+            const auto next = _theoretical_arrival - _tolerance;
+            return next > now ? next - now : Clock::duration::zero();
+        }
+
+        [[nodiscard]] inline auto get_interval() const noexcept -> Clock::duration {
+            return _interval;
+        }
+    };
+}
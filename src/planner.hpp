@@ -0,0 +1,132 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <optional>
+#include <kstd/types.hpp>
+#include "protocol.hpp"
+#include "trace.hpp"
+
+namespace fox {
+    /**
+     * Folds the commands posted by producers into a desired end-state and
+     * derives the shortest message sequence leading there from what has
+     * already been sent to the device. Opposite speed steps which have not
+     * been sent yet cancel out, a new target speed replaces the outstanding
+     * delta and a power change makes any outstanding steps obsolete.
+     * Only ever used from the IO thread.
+     */
+    class SpeedPlanner final {
+        bool _is_on;
+        kstd::i32 _speed;
+        bool _target_is_on;
+        kstd::i32 _target_speed;
+        kstd::u32 _trace_id; // Of the latest command, every message planned from here on belongs to it
+
+        public:
+
+        SpeedPlanner() noexcept:
+                _is_on(false),
+                _speed(0),
+                _target_is_on(false),
+                _target_speed(0),
+                _trace_id(NO_TRACE) {
+        }
+
+        inline auto apply(const Command& command, kstd::u32 trace_id = NO_TRACE) noexcept -> void {
+            _trace_id = trace_id;
+
+            switch (command.type) {
+                case CommandType::POWER:
+                    _target_is_on = command.value != 0;
+                    _target_speed = _target_is_on ? 1 : 0;
+                    break;
+                case CommandType::SPEED:
+                    _target_speed = command.value;
+                    break;
+                case CommandType::MODE:
+                    break; // Modes are only tracked on the host
+            }
+        }
+
+        /**
+         * Yields the next message to send and assumes it will be executed
+         * by the device, or std::nullopt if the target has been reached.
+         */
+        [[nodiscard]] inline auto next_message() noexcept -> std::optional<char> {
+            if (_target_is_on != _is_on) {
+                _is_on = _target_is_on;
+                _speed = _is_on ? 1 : 0;
+                return _is_on ? MESSAGE_ON : MESSAGE_OFF;
+            }
+
+            if (!_is_on) {
+                return std::nullopt;
+            }
+
+            if (_speed < _target_speed) {
+                ++_speed;
+                return MESSAGE_HIGHER;
+            }
+
+            if (_speed > _target_speed) {
+                --_speed;
+                return MESSAGE_LOWER;
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Like next_message, but yields absolute commands for protocols
+         * which can transmit the target speed in a single message.
+         */
+        [[nodiscard]] inline auto next_command() noexcept -> std::optional<Command> {
+            if (_target_is_on != _is_on) {
+                _is_on = _target_is_on;
+                _speed = _is_on ? 1 : 0;
+                return Command{CommandType::POWER, _is_on ? 1 : 0};
+            }
+
+            if (!_is_on) {
+                return std::nullopt;
+            }
+
+            if (_speed != _target_speed) {
+                _speed = _target_speed;
+                return Command{CommandType::SPEED, _speed};
+            }
+
+            return std::nullopt;
+        }
+
+        /**
+         * Replaces what the planner assumed to have sent with the state the
+         * device actually reported, after messages got lost on the way.
+         * Messages towards the target are planned from there again.
+         */
+        inline auto resync(bool is_on, kstd::i32 speed) noexcept -> void {
+            _is_on = is_on;
+            _speed = is_on ? speed : 0;
+        }
+
+        [[nodiscard]] inline auto has_pending() const noexcept -> bool {
+            return _target_is_on != _is_on || (_is_on && _speed != _target_speed);
+        }
+
+        [[nodiscard]] inline auto is_on() const noexcept -> bool {
+            return _is_on;
+        }
+
+        [[nodiscard]] inline auto get_speed() const noexcept -> kstd::i32 {
+            return _speed;
+        }
+
+        [[nodiscard]] inline auto get_trace_id() const noexcept -> kstd::u32 {
+            return _trace_id;
+        }
+    };
+}
@@ -0,0 +1,324 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <algorithm>
+#include <string_view>
+#include <variant>
+#include <type_traits>
+#include <kstd/types.hpp>
+#include "dto.hpp"
+#include "reflect.hpp"
+
+namespace fox {
+    enum class Protocol : kstd::u8 {
+        LEGACY, // Single char commands, newline terminated feedback
+        BINARY  // Framed commands with sequence numbers and checksums
+    };
+
+    enum class CommandType : kstd::u8 {
+        POWER,
+        SPEED,
+        MODE
+    };
+
+    struct Command final {
+        CommandType type;
+        kstd::i32 value;
+    };
+
+    constexpr char MESSAGE_ON = 'i';
+    constexpr char MESSAGE_OFF = 'o';
+    constexpr char MESSAGE_LOWER = 'l';
+    constexpr char MESSAGE_HIGHER = 'h';
+
+    enum class Feedback : kstd::u8 {
+        UNKNOWN,
+        POWER_ON,
+        POWER_OFF,
+        SPEED_UP,
+        SPEED_DOWN
+    };
+
+    [[nodiscard]] constexpr auto hash_token(std::string_view token) noexcept -> kstd::u32 {
+        kstd::u32 hash = 2166136261U; // FNV-1a
+
+        for (const auto c: token) {
+            hash = (hash ^ static_cast<kstd::u8>(c)) * 16777619U;
+        }
+
+        return hash;
+    }
+
+    [[nodiscard]] constexpr auto parse_feedback(std::string_view token) noexcept -> Feedback {
+        // Duplicate case labels would fail to compile, so the hash is perfect over the known tokens
+        switch (hash_token(token)) { // @formatter:off
+            case hash_token("power_on"):    return token == "power_on" ? Feedback::POWER_ON : Feedback::UNKNOWN;
+            case hash_token("power_off"):   return token == "power_off" ? Feedback::POWER_OFF : Feedback::UNKNOWN;
+            case hash_token("speed_up"):    return token == "speed_up" ? Feedback::SPEED_UP : Feedback::UNKNOWN;
+            case hash_token("speed_down"):  return token == "speed_down" ? Feedback::SPEED_DOWN : Feedback::UNKNOWN;
+            default:                        return Feedback::UNKNOWN;
+        } // @formatter:on
+    }
+
+    /**
+     * @return The feedback the device answers the given message with, or UNKNOWN if it doesn't.
+     */
+    [[nodiscard]] constexpr auto get_expected_feedback(char message) noexcept -> Feedback {
+        switch (message) { // @formatter:off
+            case MESSAGE_ON:        return Feedback::POWER_ON;
+            case MESSAGE_OFF:       return Feedback::POWER_OFF;
+            case MESSAGE_HIGHER:    return Feedback::SPEED_UP;
+            case MESSAGE_LOWER:     return Feedback::SPEED_DOWN;
+            default:                return Feedback::UNKNOWN;
+        } // @formatter:on
+    }
+
+    /*
+     * Binary protocol frame layout:
+     *
+     * | sync | length | opcode | sequence | payload (length bytes) | crc8 |
+     *
+     * The CRC-8 (polynomial 0x07) covers everything between sync and crc.
+     * Multi-byte payload fields are little endian. Commands are answered with
+     * an ACK carrying the same sequence number and the device state, frames
+     * which fail the checksum on the device are answered with a NACK.
+     */
+    constexpr kstd::u8 FRAME_SYNC = 0xA5;
+    constexpr kstd::u8 PROTOCOL_VERSION = 1;
+    constexpr kstd::usize FRAME_HEADER_SIZE = 4;
+    constexpr kstd::usize MAX_PAYLOAD_SIZE = 16;
+    constexpr kstd::usize MAX_FRAME_SIZE = FRAME_HEADER_SIZE + MAX_PAYLOAD_SIZE + 1;
+
+    enum class Opcode : kstd::u8 {
+        // Host -> Device
+        HELLO       = 0x01, // Payload: u8 version
+        POWER       = 0x10, // Payload: u8 is_on
+        SET_SPEED   = 0x11, // Payload: i32 speed
+        // Device -> Host
+        HELLO_ACK   = 0x81, // Payload: u8 version
+        ACK         = 0x90, // Payload: u8 is_on, i32 speed
+        NACK        = 0x91, // No payload
+        STATE       = 0x92  // Payload: u8 is_on, i32 speed
+    };
+
+    [[nodiscard]] constexpr auto crc8(std::span<const kstd::u8> data) noexcept -> kstd::u8 {
+        kstd::u8 crc = 0;
+
+        for (const auto byte: data) {
+            crc ^= byte;
+
+            for (auto bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80) != 0 ? static_cast<kstd::u8>((crc << 1) ^ 0x07) : static_cast<kstd::u8>(crc << 1);
+            }
+        }
+
+        return crc;
+    }
+
+    template<typename T>
+    requires(std::is_integral_v<T>)
+    constexpr auto write_le(kstd::u8* data, T value) noexcept -> void {
+        for (kstd::usize i = 0; i < sizeof(T); ++i) {
+            data[i] = static_cast<kstd::u8>(static_cast<std::make_unsigned_t<T>>(value) >> (i * 8));
+        }
+    }
+
+    template<typename T>
+    requires(std::is_integral_v<T>)
+    [[nodiscard]] constexpr auto read_le(const kstd::u8* data) noexcept -> T {
+        std::make_unsigned_t<T> value = 0;
+
+        for (kstd::usize i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<std::make_unsigned_t<T>>(static_cast<std::make_unsigned_t<T>>(data[i]) << (i * 8));
+        }
+
+        return static_cast<T>(value);
+    }
+
+    struct Frame final {
+        std::array<kstd::u8, MAX_FRAME_SIZE> data;
+        kstd::usize size;
+
+        [[nodiscard]] inline auto as_view() const noexcept -> std::string_view {
+            return {reinterpret_cast<const char*>(data.data()), size};
+        }
+    };
+
+    [[nodiscard]] constexpr auto encode_frame(Opcode opcode, kstd::u8 sequence, std::span<const kstd::u8> payload) noexcept -> Frame {
+        Frame frame{};
+        const auto payload_size = std::min(payload.size(), MAX_PAYLOAD_SIZE);
+
+        frame.data[0] = FRAME_SYNC;
+        frame.data[1] = static_cast<kstd::u8>(payload_size);
+        frame.data[2] = static_cast<kstd::u8>(opcode);
+        frame.data[3] = sequence;
+        std::copy_n(payload.begin(), payload_size, frame.data.begin() + FRAME_HEADER_SIZE);
+
+        const auto crc_offset = FRAME_HEADER_SIZE + payload_size;
+        frame.data[crc_offset] = crc8(std::span(frame.data).subspan(1, crc_offset - 1));
+        frame.size = crc_offset + 1;
+
+        return frame;
+    }
+
+    [[nodiscard]] constexpr auto get_task_opcode(dto::TaskType type) noexcept -> Opcode {
+        return type == dto::TaskType::POWER ? Opcode::POWER : Opcode::SET_SPEED;
+    }
+
+    /**
+     * Writes all reflected members back to back as little endian integers,
+     * booleans take a single byte and enums the size of their underlying type.
+     */
+    template<Reflected T>
+    constexpr auto encode_payload(const T& value, kstd::u8* data) noexcept -> void {
+        for_each_field<T>([&value, &data](const auto& field) {
+            using Member = typename std::remove_cvref_t<decltype(field)>::Member;
+            const auto member = value.*field.member;
+
+            if constexpr (std::is_same_v<Member, bool>) {
+                write_le<kstd::u8>(data, member ? 1 : 0);
+            }
+            else if constexpr (std::is_enum_v<Member>) {
+                write_le<std::underlying_type_t<Member>>(data, static_cast<std::underlying_type_t<Member>>(member));
+            }
+            else {
+                write_le<Member>(data, member);
+            }
+
+            data += get_wire_size<Member>();
+        });
+    }
+
+    // Modes are only tracked on the host, the device has no notion of them
+    template<Reflected T>
+    requires(T::TYPE != dto::TaskType::MODE)
+    [[nodiscard]] constexpr auto encode_task(const T& task, kstd::u8 sequence) noexcept -> Frame {
+        std::array<kstd::u8, get_payload_size<T>()> payload{};
+        encode_payload(task, payload.data());
+        return encode_frame(get_task_opcode(T::TYPE), sequence, payload);
+    }
+
+    [[nodiscard]] constexpr auto to_command(const dto::Task& task) noexcept -> Command {
+        switch (dto::get_task_type(task)) {
+            case dto::TaskType::POWER:
+                return {CommandType::POWER, std::get<dto::PowerTask>(task).is_on ? 1 : 0};
+            case dto::TaskType::SPEED:
+                return {CommandType::SPEED, std::get<dto::SpeedTask>(task).speed};
+            default:
+                return {CommandType::MODE, static_cast<kstd::i32>(std::get<dto::ModeTask>(task).mode)};
+        }
+    }
+
+    /**
+     * Encodes a power or speed command, the planner never yields any other.
+     */
+    [[nodiscard]] constexpr auto encode_command(const Command& command, kstd::u8 sequence) noexcept -> Frame {
+        if (command.type == CommandType::POWER) {
+            return encode_task(dto::PowerTask{command.value != 0}, sequence);
+        }
+
+        return encode_task(dto::SpeedTask{command.value}, sequence);
+    }
+
+    // The payloads generated from the task fields have to match the frame layout documented above
+    static_assert(get_payload_size<dto::PowerTask>() == 1);
+    static_assert(get_payload_size<dto::SpeedTask>() == sizeof(kstd::i32));
+    static_assert(encode_command({CommandType::SPEED, 0x01020304}, 0).data[FRAME_HEADER_SIZE] == 0x04);
+
+    constexpr auto HELLO_FRAME = encode_frame(Opcode::HELLO, 0, std::array<kstd::u8, 1>{PROTOCOL_VERSION});
+
+    // Legacy firmware receives the handshake as well, so it must not contain any command characters
+    static_assert(std::none_of(HELLO_FRAME.data.begin(), HELLO_FRAME.data.begin() + HELLO_FRAME.size, [](kstd::u8 byte) {
+        return byte == MESSAGE_ON || byte == MESSAGE_OFF || byte == MESSAGE_LOWER || byte == MESSAGE_HIGHER;
+    }));
+
+    struct DecodedFrame final {
+        Opcode opcode;
+        kstd::u8 sequence;
+        std::span<const kstd::u8> payload;
+    };
+
+    /**
+     * Incrementally extracts frames from a byte stream, resynchronizing on the
+     * next sync byte whenever garbage or a corrupted frame is encountered.
+     */
+    class FrameDecoder final {
+        std::array<kstd::u8, MAX_FRAME_SIZE> _buffer;
+        kstd::usize _size;
+        kstd::usize _num_corrupted;
+
+        /**
+         * Drops the given number of bytes from the front of the buffer and
+         * everything following them up to the next sync byte.
+         */
+        inline auto consume(kstd::usize count) noexcept -> void {
+            const auto begin = _buffer.begin();
+            const auto next = std::find(begin + count, begin + _size, FRAME_SYNC);
+            _size = static_cast<kstd::usize>(std::copy(next, begin + _size, begin) - begin);
+        }
+
+        public:
+
+        FrameDecoder() noexcept:
+                _buffer(),
+                _size(0),
+                _num_corrupted(0) {
+        }
+
+        template<typename F>
+        requires(std::is_invocable_v<F, const DecodedFrame&>)
+        inline auto feed(std::span<const kstd::u8> data, F&& on_frame) noexcept -> void {
+            for (const auto byte: data) {
+                if (_size == 0 && byte != FRAME_SYNC) {
+                    continue; // Hunt for the start of the next frame
+                }
+
+                _buffer[_size++] = byte;
+
+                // A corrupted frame only gives up its sync byte, the bytes after it
+                // may hold the next frames and are scanned again
+                while (_size > 1) {
+                    if (_buffer[1] > MAX_PAYLOAD_SIZE) {
+                        ++_num_corrupted;
+                        consume(1);
+                        continue;
+                    }
+
+                    const auto frame_size = FRAME_HEADER_SIZE + _buffer[1] + 1;
+
+                    if (_size < frame_size) {
+                        break;
+                    }
+
+                    if (crc8(std::span(_buffer).subspan(1, frame_size - 2)) != _buffer[frame_size - 1]) {
+                        ++_num_corrupted;
+                        consume(1);
+                        continue;
+                    }
+
+                    on_frame(DecodedFrame{
+                        static_cast<Opcode>(_buffer[2]),
+                        _buffer[3],
+                        std::span(_buffer).subspan(FRAME_HEADER_SIZE, _buffer[1])
+                    });
+
+                    consume(frame_size);
+                }
+            }
+        }
+
+        inline auto reset() noexcept -> void {
+            _size = 0;
+        }
+
+        [[nodiscard]] inline auto get_num_corrupted() const noexcept -> kstd::usize {
+            return _num_corrupted;
+        }
+    };
+}
@@ -0,0 +1,182 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <spdlog/spdlog.h>
+#include <kstd/platform/platform.hpp>
+#include "reactor.hpp"
+
+namespace fox {
+    constexpr kstd::i32 MAX_EVENTS_PER_WAIT = 16;
+
+    Timer::Timer() :
+            _handle(::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) {
+        if (_handle == -1) {
+            throw std::runtime_error(fmt::format("Could not create timer: {}", kstd::platform::get_last_error()));
+        }
+    }
+
+    Timer::~Timer() noexcept {
+        ::close(_handle);
+    }
+
+    auto Timer::arm(std::chrono::nanoseconds delay) noexcept -> void {
+        using namespace std::chrono_literals;
+
+        // A zero expiration would disarm the timer, so fire as soon as possible instead
+        const auto count = std::max(delay, 1ns).count();
+
+        itimerspec spec{};
+        spec.it_value.tv_sec = static_cast<time_t>(count / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(count % 1000000000);
+        ::timerfd_settime(_handle, 0, &spec, nullptr);
+    }
+
+    auto Timer::disarm() noexcept -> void {
+        itimerspec spec{};
+        ::timerfd_settime(_handle, 0, &spec, nullptr);
+    }
+
+    auto Timer::acknowledge() noexcept -> void {
+        kstd::u64 expirations = 0;
+        [[maybe_unused]] const auto result = ::read(_handle, &expirations, sizeof(expirations));
+    }
+
+    Reactor::Reactor() :
+            _epoll_handle(::epoll_create1(EPOLL_CLOEXEC)),
+            _wakeup_handle(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+            _is_running(true),
+            _registrations(),
+            _wakeup_handler() {
+        if (_epoll_handle == -1 || _wakeup_handle == -1) {
+            throw std::runtime_error(fmt::format("Could not create reactor: {}", kstd::platform::get_last_error()));
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr; // Reserved for the wakeup handle
+
+        if (::epoll_ctl(_epoll_handle, EPOLL_CTL_ADD, _wakeup_handle, &event) != 0) {
+            throw std::runtime_error(fmt::format("Could not register reactor wakeup handle: {}", kstd::platform::get_last_error()));
+        }
+    }
+
+    Reactor::~Reactor() noexcept {
+        ::close(_wakeup_handle);
+        ::close(_epoll_handle);
+    }
+
+    auto Reactor::find_registration(kstd::i32 handle) noexcept -> Registration* {
+        const auto itr = std::find_if(_registrations.begin(), _registrations.end(), [handle](const auto& registration) {
+            return registration->handle == handle;
+        });
+
+        return itr == _registrations.end() ? nullptr : itr->get();
+    }
+
+    auto Reactor::collect_removed() noexcept -> void {
+        std::erase_if(_registrations, [](const auto& registration) {
+            return registration->handle == -1;
+        });
+    }
+
+    auto Reactor::add(kstd::i32 handle, kstd::u32 events, EventHandler handler) noexcept -> bool {
+        auto registration = std::make_unique<Registration>(Registration{handle, std::move(handler)});
+
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = registration.get();
+
+        if (::epoll_ctl(_epoll_handle, EPOLL_CTL_ADD, handle, &event) != 0) {
+            spdlog::error("Could not register handle {} with reactor: {}", handle, kstd::platform::get_last_error());
+            return false;
+        }
+
+        _registrations.push_back(std::move(registration));
+        return true;
+    }
+
+    auto Reactor::modify(kstd::i32 handle, kstd::u32 events) noexcept -> bool {
+        auto* registration = find_registration(handle);
+
+        if (registration == nullptr) {
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = registration;
+
+        return ::epoll_ctl(_epoll_handle, EPOLL_CTL_MOD, handle, &event) == 0;
+    }
+
+    auto Reactor::remove(kstd::i32 handle) noexcept -> void {
+        auto* registration = find_registration(handle);
+
+        if (registration == nullptr) {
+            return;
+        }
+
+        ::epoll_ctl(_epoll_handle, EPOLL_CTL_DEL, handle, nullptr);
+        // Events for this handle may still be pending in the current batch, so defer the deletion
+        registration->handle = -1;
+    }
+
+    auto Reactor::wakeup() noexcept -> void {
+        constexpr kstd::u64 value = 1;
+        [[maybe_unused]] const auto result = ::write(_wakeup_handle, &value, sizeof(value));
+    }
+
+    auto Reactor::stop() noexcept -> void {
+        _is_running = false;
+        wakeup();
+    }
+
+    auto Reactor::run() noexcept -> void {
+        epoll_event events[MAX_EVENTS_PER_WAIT];
+
+        while (_is_running) {
+            const auto num_events = ::epoll_wait(_epoll_handle, events, MAX_EVENTS_PER_WAIT, -1);
+
+            if (num_events == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                spdlog::error("Reactor wait failed: {}", kstd::platform::get_last_error());
+                break;
+            }
+
+            for (auto i = 0; i < num_events && _is_running; ++i) {
+                const auto& event = events[i];
+                auto* registration = static_cast<Registration*>(event.data.ptr);
+
+                if (registration == nullptr) {
+                    kstd::u64 value = 0;
+                    [[maybe_unused]] const auto result = ::read(_wakeup_handle, &value, sizeof(value));
+
+                    if (_wakeup_handler) {
+                        _wakeup_handler();
+                    }
+
+                    continue;
+                }
+
+                if (registration->handle == -1) {
+                    continue; // Removed by a previous handler
+                }
+
+                registration->handler(event.events);
+            }
+
+            collect_removed();
+        }
+    }
+}
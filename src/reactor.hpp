@@ -0,0 +1,121 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <sys/epoll.h>
+#include <kstd/types.hpp>
+
+namespace fox {
+    using EventHandler = std::function<void(kstd::u32)>;
+
+    /**
+     * One-shot timer backed by a timerfd, meant to be registered with a reactor.
+     */
+    class Timer final {
+        kstd::i32 _handle;
+
+        public:
+
+        Timer();
+
+        Timer(const Timer& other) = delete;
+
+        Timer(Timer&& other) = delete;
+
+        ~Timer() noexcept;
+
+        auto operator =(const Timer& other) -> Timer& = delete;
+
+        auto operator =(Timer&& other) -> Timer& = delete;
+
+        auto arm(std::chrono::nanoseconds delay) noexcept -> void;
+
+        auto disarm() noexcept -> void;
+
+        /**
+         * Consumes the expiration so the handle stops being readable.
+         */
+        auto acknowledge() noexcept -> void;
+
+        [[nodiscard]] inline auto get_handle() const noexcept -> kstd::i32 {
+            return _handle;
+        }
+    };
+
+    /**
+     * Single threaded epoll event loop. File descriptors are registered
+     * together with a handler which is invoked on the reactor thread
+     * whenever the requested events become ready. An internal eventfd
+     * allows other threads to wake the loop up (for example when new
+     * data was queued for sending) and to shut it down.
+     *
+     * Handlers may only be added/removed before the reactor is started
+     * or from within another handler running on the reactor thread.
+     */
+    class Reactor final {
+        struct Registration final {
+            kstd::i32 handle;
+            EventHandler handler;
+        };
+
+        kstd::i32 _epoll_handle;
+        kstd::i32 _wakeup_handle;
+        std::atomic_bool _is_running;
+        std::vector<std::unique_ptr<Registration>> _registrations;
+        std::function<void()> _wakeup_handler;
+
+        auto find_registration(kstd::i32 handle) noexcept -> Registration*;
+
+        auto collect_removed() noexcept -> void;
+
+        public:
+
+        Reactor();
+
+        Reactor(const Reactor& other) = delete;
+
+        Reactor(Reactor&& other) = delete;
+
+        ~Reactor() noexcept;
+
+        auto operator =(const Reactor& other) -> Reactor& = delete;
+
+        auto operator =(Reactor&& other) -> Reactor& = delete;
+
+        auto add(kstd::i32 handle, kstd::u32 events, EventHandler handler) noexcept -> bool;
+
+        auto modify(kstd::i32 handle, kstd::u32 events) noexcept -> bool;
+
+        auto remove(kstd::i32 handle) noexcept -> void;
+
+        /**
+         * Wakes up the reactor thread and invokes the wakeup handler.
+         * Safe to call from any thread, multiple wakeups are coalesced.
+         */
+        auto wakeup() noexcept -> void;
+
+        /**
+         * Makes the reactor return from run() as soon as possible.
+         * Safe to call from any thread.
+         */
+        auto stop() noexcept -> void;
+
+        auto run() noexcept -> void;
+
+        inline auto set_wakeup_handler(std::function<void()> handler) noexcept -> void {
+            _wakeup_handler = std::move(handler);
+        }
+
+        [[nodiscard]] inline auto is_running() const noexcept -> bool {
+            return _is_running;
+        }
+    };
+}
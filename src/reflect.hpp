@@ -0,0 +1,129 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Describes one member of a reflected type: its name on the wire and the
+     * range of values a decoder accepts for it. Reflected types list their
+     * descriptors in a static constexpr FIELDS tuple, from which encoders and
+     * decoders for every format are generated.
+     */
+    template<typename T, typename M>
+    struct FieldDescriptor final {
+        using Owner = T;
+        using Member = M;
+
+        std::string_view name;
+        M T::* member;
+        kstd::i64 min_value;
+        kstd::i64 max_value;
+    };
+
+    template<typename T>
+    concept Reflected = requires {
+        std::tuple_size<std::remove_cvref_t<decltype(T::FIELDS)>>::value;
+    };
+
+    template<typename T, typename M>
+    requires(std::same_as<M, bool>)
+    [[nodiscard]] constexpr auto field(std::string_view name, M T::* member) noexcept -> FieldDescriptor<T, M> {
+        return {name, member, 0, 1};
+    }
+
+    template<typename T, typename M>
+    requires(std::integral<M> && !std::same_as<M, bool>)
+    [[nodiscard]] constexpr auto field(std::string_view name, M T::* member, kstd::i64 min_value = std::numeric_limits<M>::min(),
+                                       kstd::i64 max_value = static_cast<kstd::i64>(std::min<kstd::u64>(std::numeric_limits<M>::max(), std::numeric_limits<kstd::i64>::max()))) noexcept -> FieldDescriptor<T, M> {
+        return {name, member, min_value, max_value};
+    }
+
+    // Enums have no known upper bound, so the last valid enumerator has to be given
+    template<typename T, typename M>
+    requires(std::is_enum_v<M>)
+    [[nodiscard]] constexpr auto field(std::string_view name, M T::* member, M max_value) noexcept -> FieldDescriptor<T, M> {
+        return {name, member, 0, static_cast<kstd::i64>(max_value)};
+    }
+
+    template<Reflected T>
+    [[nodiscard]] constexpr auto get_num_fields() noexcept -> kstd::usize {
+        return std::tuple_size_v<std::remove_cvref_t<decltype(T::FIELDS)>>;
+    }
+
+    template<Reflected T, typename F>
+    constexpr auto for_each_field(F&& function) noexcept -> void {
+        std::apply([&function](const auto& ... fields) {
+            (function(fields), ...);
+        }, T::FIELDS);
+    }
+
+    /**
+     * Writes all reflected members as key/value pairs into the currently open
+     * object of a JsonWriter or BinaryWriter.
+     */
+    template<typename W, Reflected T>
+    constexpr auto write_fields(W& writer, const T& value) noexcept -> void {
+        for_each_field<T>([&writer, &value](const auto& field) {
+            writer.field(field.name, value.*field.member);
+        });
+    }
+
+    template<typename W, Reflected T>
+    constexpr auto write_object(W& writer, const T& value) noexcept -> void {
+        writer.begin_object();
+        write_fields(writer, value);
+        writer.end_object();
+    }
+
+    /**
+     * Assigns a decoded scalar to a member after checking it against the range of its descriptor.
+     * @return False if the value is out of range.
+     */
+    template<typename T, typename M>
+    constexpr auto assign_field(const FieldDescriptor<T, M>& field, T& value, kstd::i64 decoded) noexcept -> bool {
+        if (decoded < field.min_value || decoded > field.max_value) {
+            return false;
+        }
+
+        value.*field.member = static_cast<M>(decoded);
+        return true;
+    }
+
+    /**
+     * @return The width of a member in the little endian serial frame encoding.
+     */
+    template<typename M>
+    [[nodiscard]] constexpr auto get_wire_size() noexcept -> kstd::usize {
+        if constexpr (std::is_enum_v<M>) {
+            return sizeof(std::underlying_type_t<M>);
+        }
+        else {
+            return sizeof(M);
+        }
+    }
+
+    /**
+     * @return The size of all reflected members in the serial frame encoding.
+     */
+    template<Reflected T>
+    [[nodiscard]] constexpr auto get_payload_size() noexcept -> kstd::usize {
+        kstd::usize size = 0;
+
+        for_each_field<T>([&size](const auto& field) {
+            size += get_wire_size<typename std::remove_cvref_t<decltype(field)>::Member>();
+        });
+
+        return size;
+    }
+}
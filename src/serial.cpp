@@ -0,0 +1,37 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+// Intentionally doesn't include serial.hpp, termios2 is only available through
+// the kernel headers which conflict with the glibc <termios.h> definitions.
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+#include <kstd/types.hpp>
+
+namespace fox::serial {
+    auto set_custom_baud_rate(kstd::i32 handle, kstd::u32 rate) noexcept -> bool {
+        termios2 tty{};
+
+        if (::ioctl(handle, TCGETS2, &tty) != 0) {
+            return false;
+        }
+
+        tty.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+        tty.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+        tty.c_ispeed = rate;
+        tty.c_ospeed = rate;
+
+        return ::ioctl(handle, TCSETS2, &tty) == 0;
+    }
+
+    auto get_effective_baud_rate(kstd::i32 handle) noexcept -> kstd::u32 {
+        termios2 tty{};
+
+        if (::ioctl(handle, TCGETS2, &tty) != 0) {
+            return 0;
+        }
+
+        return tty.c_ospeed;
+    }
+}
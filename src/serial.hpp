@@ -5,8 +5,12 @@
 
 #pragma once
 
+#include <string>
 #include <string_view>
 #include <mutex>
+#include <cerrno>
+#include <optional>
+#include <limits>
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
@@ -15,79 +19,146 @@
 #include <kstd/platform/platform.hpp>
 
 namespace fox::serial {
-    enum class BaudRate : kstd::u8 {
+    enum class BaudRate : kstd::u32 {
         // @formatter:off
-        _50     = B50,
-        _75     = B75,
-        _110	= B110,
-        _134	= B134,
-        _150	= B150,
-        _200	= B200,
-        _300	= B300,
-        _600	= B600,
-        _1200	= B1200,
-        _1800	= B1800,
-        _2400	= B2400,
-        _4800	= B4800,
-        _9600	= B9600,
-        _19200	= B19200,
-        _38400	= B38400
+        _50         = B50,
+        _75         = B75,
+        _110	    = B110,
+        _134	    = B134,
+        _150	    = B150,
+        _200	    = B200,
+        _300	    = B300,
+        _600	    = B600,
+        _1200	    = B1200,
+        _1800	    = B1800,
+        _2400	    = B2400,
+        _4800	    = B4800,
+        _9600	    = B9600,
+        _19200	    = B19200,
+        _38400	    = B38400,
+        _57600      = B57600,
+        _115200     = B115200,
+        _230400     = B230400,
+        _460800     = B460800,
+        _500000     = B500000,
+        _576000     = B576000,
+        _921600     = B921600,
+        _1000000    = B1000000,
+        _1152000    = B1152000,
+        _1500000    = B1500000,
+        _2000000    = B2000000,
+        _2500000    = B2500000,
+        _3000000    = B3000000,
+        _3500000    = B3500000,
+        _4000000    = B4000000
         // @formatter:on
     };
 
-    [[nodiscard]] inline auto find_closest_baud_rate(kstd::u32 rate) noexcept -> BaudRate {
-        // @formatter:off
-        if(rate <= 50)          return BaudRate::_50;
-        else if(rate <= 75)     return BaudRate::_75;
-        else if(rate <= 110)    return BaudRate::_110;
-        else if(rate <= 134)    return BaudRate::_134;
-        else if(rate <= 150)    return BaudRate::_150;
-        else if(rate <= 200)    return BaudRate::_200;
-        else if(rate <= 300)    return BaudRate::_300;
-        else if(rate <= 600)    return BaudRate::_600;
-        else if(rate <= 1200)   return BaudRate::_1200;
-        else if(rate <= 1800)   return BaudRate::_1800;
-        else if(rate <= 2400)   return BaudRate::_2400;
-        else if(rate <= 4800)   return BaudRate::_4800;
-        else if(rate <= 9600)   return BaudRate::_9600; // NOLINT
-        else if(rate <= 19200)  return BaudRate::_19200;
-        else if(rate <= 38400)  return BaudRate::_38400;
-        else                    return BaudRate::_9600; // Default
-        // @formatter:on
-    }
+    constexpr BaudRate BAUD_RATES[] = { // @formatter:off
+        BaudRate::_50, BaudRate::_75, BaudRate::_110, BaudRate::_134, BaudRate::_150, BaudRate::_200,
+        BaudRate::_300, BaudRate::_600, BaudRate::_1200, BaudRate::_1800, BaudRate::_2400, BaudRate::_4800,
+        BaudRate::_9600, BaudRate::_19200, BaudRate::_38400, BaudRate::_57600, BaudRate::_115200,
+        BaudRate::_230400, BaudRate::_460800, BaudRate::_500000, BaudRate::_576000, BaudRate::_921600,
+        BaudRate::_1000000, BaudRate::_1152000, BaudRate::_1500000, BaudRate::_2000000, BaudRate::_2500000,
+        BaudRate::_3000000, BaudRate::_3500000, BaudRate::_4000000
+    }; // @formatter:on
 
-    [[nodiscard]] inline auto to_baud_rate_count(BaudRate rate) noexcept -> uint32_t {
+    [[nodiscard]] constexpr auto to_baud_rate_count(BaudRate rate) noexcept -> kstd::u32 {
         switch(rate) { // @formatter:off
-            case BaudRate::_50:     return 50;
-            case BaudRate::_75:     return 75;
-            case BaudRate::_110:    return 110;
-            case BaudRate::_134:    return 134;
-            case BaudRate::_150:    return 150;
-            case BaudRate::_200:    return 200;
-            case BaudRate::_300:    return 300;
-            case BaudRate::_600:    return 600;
-            case BaudRate::_1200:   return 1200;
-            case BaudRate::_1800:   return 1800;
-            case BaudRate::_2400:   return 2400;
-            case BaudRate::_4800:   return 4800;
-            case BaudRate::_9600:   return 9600;
-            case BaudRate::_19200:  return 19200;
-            case BaudRate::_38400:  return 38400;
-            default:                return 9600; // Default
+            case BaudRate::_50:         return 50;
+            case BaudRate::_75:         return 75;
+            case BaudRate::_110:        return 110;
+            case BaudRate::_134:        return 134;
+            case BaudRate::_150:        return 150;
+            case BaudRate::_200:        return 200;
+            case BaudRate::_300:        return 300;
+            case BaudRate::_600:        return 600;
+            case BaudRate::_1200:       return 1200;
+            case BaudRate::_1800:       return 1800;
+            case BaudRate::_2400:       return 2400;
+            case BaudRate::_4800:       return 4800;
+            case BaudRate::_9600:       return 9600;
+            case BaudRate::_19200:      return 19200;
+            case BaudRate::_38400:      return 38400;
+            case BaudRate::_57600:      return 57600;
+            case BaudRate::_115200:     return 115200;
+            case BaudRate::_230400:     return 230400;
+            case BaudRate::_460800:     return 460800;
+            case BaudRate::_500000:     return 500000;
+            case BaudRate::_576000:     return 576000;
+            case BaudRate::_921600:     return 921600;
+            case BaudRate::_1000000:    return 1000000;
+            case BaudRate::_1152000:    return 1152000;
+            case BaudRate::_1500000:    return 1500000;
+            case BaudRate::_2000000:    return 2000000;
+            case BaudRate::_2500000:    return 2500000;
+            case BaudRate::_3000000:    return 3000000;
+            case BaudRate::_3500000:    return 3500000;
+            case BaudRate::_4000000:    return 4000000;
+            default:                    return 9600; // Default
         } // @formatter:on
     }
 
+    /**
+     * @return The standard rate with the smallest difference to the given one, the lower one on a tie.
+     */
+    [[nodiscard]] constexpr auto find_closest_baud_rate(kstd::u32 rate) noexcept -> BaudRate {
+        auto closest = BAUD_RATES[0];
+        auto closest_difference = std::numeric_limits<kstd::u32>::max();
+
+        for (const auto baud_rate: BAUD_RATES) {
+            const auto count = to_baud_rate_count(baud_rate);
+            const auto difference = count > rate ? count - rate : rate - count;
+
+            if (difference < closest_difference) {
+                closest = baud_rate;
+                closest_difference = difference;
+            }
+        }
+
+        return closest;
+    }
+
+    static_assert(find_closest_baud_rate(250000) == BaudRate::_230400 && find_closest_baud_rate(400000) == BaudRate::_460800);
+
+    [[nodiscard]] constexpr auto find_exact_baud_rate(kstd::u32 rate) noexcept -> std::optional<BaudRate> {
+        for (const auto baud_rate: BAUD_RATES) {
+            if (rate == to_baud_rate_count(baud_rate)) {
+                return baud_rate;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // Implemented in serial.cpp, since the termios2 API can't be included together with <termios.h>
+
+    /**
+     * Configures an arbitrary baud rate through termios2/BOTHER.
+     * @return True if the driver accepted the rate.
+     */
+    auto set_custom_baud_rate(kstd::i32 handle, kstd::u32 rate) noexcept -> bool;
+
+    /**
+     * @return The output baud rate the driver actually uses, or 0 if it can't be determined.
+     */
+    [[nodiscard]] auto get_effective_baud_rate(kstd::i32 handle) noexcept -> kstd::u32;
+
     class SerialConnection final {
         std::string _device_name;
         int32_t _handle;
-        BaudRate _baud_rate;
+        kstd::u32 _baud_rate;
+        std::string _tx_buffer;
+        kstd::usize _tx_offset;
 
         public:
 
-        SerialConnection(std::string device_name, BaudRate baud_rate) noexcept:
+        SerialConnection(std::string device_name, kstd::u32 baud_rate) noexcept:
                 _device_name(std::move(device_name)),
-                _handle(::open(_device_name.data(), O_RDWR)),
-                _baud_rate(baud_rate) {
+                _handle(::open(_device_name.data(), O_RDWR | O_NOCTTY | O_NONBLOCK)),
+                _baud_rate(baud_rate),
+                _tx_buffer(),
+                _tx_offset(0) {
             if (_handle == -1) {
                 throw std::runtime_error(fmt::format("Could not open serial port: {}", kstd::platform::get_last_error()));
             }
@@ -102,23 +173,35 @@ namespace fox::serial {
             tty.c_cflag &= ~(CRTSCTS);
             tty.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
             tty.c_oflag &= ~(OPOST | ONLCR);
-            tty.c_cc[VTIME] = 10;
+            tty.c_cc[VTIME] = 0; // Non-blocking, readiness is signalled through the reactor
             tty.c_cc[VMIN] = 0;
 
-            cfsetispeed(&tty, static_cast<speed_t>(baud_rate));
-            cfsetospeed(&tty, static_cast<speed_t>(baud_rate));
+            const auto standard_rate = find_exact_baud_rate(baud_rate);
+            const auto fallback_rate = standard_rate.value_or(find_closest_baud_rate(baud_rate));
+
+            cfsetispeed(&tty, static_cast<speed_t>(fallback_rate));
+            cfsetospeed(&tty, static_cast<speed_t>(fallback_rate));
 
             if (tcsetattr(_handle, TCSANOW, &tty) != 0) {
                 throw std::runtime_error(fmt::format("Could not configure serial port: {}", kstd::platform::get_last_error()));
             }
 
-            spdlog::info("Opened serial connection {}", _handle);
+            if (!standard_rate && !set_custom_baud_rate(_handle, baud_rate)) {
+                spdlog::warn("Custom baud rate {} is not supported by the driver, using {}", baud_rate, to_baud_rate_count(fallback_rate));
+            }
+
+            const auto effective_rate = get_effective_baud_rate(_handle);
+            _baud_rate = effective_rate != 0 ? effective_rate : to_baud_rate_count(fallback_rate);
+
+            spdlog::info("Opened serial connection {} at {} baud", _handle, _baud_rate);
         }
 
         SerialConnection() noexcept:
                 _device_name("Unknown"),
                 _handle(-1),
-                _baud_rate(BaudRate::_9600) {
+                _baud_rate(9600),
+                _tx_buffer(),
+                _tx_offset(0) {
         }
 
         SerialConnection(const SerialConnection& other) noexcept = default;
@@ -138,7 +221,10 @@ namespace fox::serial {
             return _handle;
         }
 
-        [[nodiscard]] inline auto get_baud_rate() const noexcept -> BaudRate {
+        /**
+         * @return The effective baud rate of the connection, which may differ from the requested one.
+         */
+        [[nodiscard]] inline auto get_baud_rate() const noexcept -> kstd::u32 {
             return _baud_rate;
         }
 
@@ -157,6 +243,63 @@ namespace fox::serial {
             return ::write(_handle, &message, message_size) == message_size;
         }
 
+        /**
+         * Appends a message to the pending TX buffer without writing it yet.
+         */
+        template<typename M>
+        requires(std::is_standard_layout_v<M>)
+        inline auto enqueue(const M& message) noexcept -> void {
+            _tx_buffer.append(reinterpret_cast<const char*>(&message), sizeof(M));
+        }
+
+        inline auto enqueue_bytes(std::string_view bytes) noexcept -> void {
+            _tx_buffer.append(bytes);
+        }
+
+        /**
+         * Hands all pending bytes to the kernel with a single write.
+         * Bytes which were not accepted stay buffered for the next flush.
+         * @return True if the buffer was drained completely, false if the
+         *  handle has to become writable again before flushing the rest.
+         */
+        inline auto flush() noexcept -> kstd::Result<bool> {
+            const auto num_pending = _tx_buffer.size() - _tx_offset;
+
+            if (num_pending == 0) {
+                return true;
+            }
+
+            const auto result = ::write(_handle, _tx_buffer.data() + _tx_offset, num_pending);
+
+            if (result == -1) {
+                if (errno == EAGAIN || errno == EINTR) {
+                    return false;
+                }
+
+                _tx_buffer.clear();
+                _tx_offset = 0;
+                return {std::unexpected(fmt::format("Could not write to serial port: {}", kstd::platform::get_last_error()))};
+            }
+
+            _tx_offset += static_cast<kstd::usize>(result);
+
+            if (_tx_offset < _tx_buffer.size()) {
+                return false;
+            }
+
+            _tx_buffer.clear();
+            _tx_offset = 0;
+            return true;
+        }
+
+        [[nodiscard]] inline auto get_pending() const noexcept -> std::string_view {
+            return std::string_view(_tx_buffer).substr(_tx_offset);
+        }
+
+        [[nodiscard]] inline auto has_pending() const noexcept -> bool {
+            return _tx_offset < _tx_buffer.size();
+        }
+
         template<typename M>
         requires(std::is_standard_layout_v<M>)
         inline auto try_read(M& message) noexcept -> bool {
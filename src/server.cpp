@@ -4,285 +4,949 @@
  */
 
 #include <thread>
+#include <span>
+#include <array>
 #include <string>
-#include <iostream>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fmt/ranges.h>
 #include <kstd/errors.hpp>
 #include <spdlog/spdlog.h>
 
 #include "server.hpp"
 #include "monitor.hpp"
+#include "gateway.hpp"
+#include "task_reducer.hpp"
+#include "metrics.hpp"
 
 namespace fox
 {
-    Server::Server(std::string device_name, kstd::u32 baud_rate) noexcept:
-        _connection(serial::SerialConnection(std::move(device_name), serial::find_closest_baud_rate(baud_rate))),
+    Server::Server(Lifecycle& lifecycle, std::string device_name, kstd::u32 baud_rate, const serial::PacingPolicy& pacing, const serial::FlowControlPolicy& flow_control, bool negotiate_binary, bool has_console) noexcept:
+        _connection(serial::SerialConnection(std::move(device_name), baud_rate)),
+        _lifecycle(lifecycle),
         _monitor(),
+        _reactor(),
         _is_running(true),
         _is_busy(false),
-        _commands(),
-        _message_queue()
+        _is_connected(true),
+        _command_queue(),
+        _is_tx_pending(false),
+        _is_tx_idle(true),
+        _settle_start(0),
+        _planner(),
+        _is_planner_stale(false),
+        _pacer(pacing, _connection.get_baud_rate()),
+        _tx_timer(),
+        _is_tx_blocked(false),
+        _flow_control(flow_control),
+        _ack_timer(),
+        _num_in_flight(0),
+        _round_trip_time(0),
+        _rx_framer(),
+        _rx_decoder(),
+        _protocol(Protocol::LEGACY),
+        _is_negotiating(negotiate_binary),
+        _num_negotiation_attempts(0),
+        _negotiation_timer(),
+        _tx_sequence(0),
+        _gateway(),
+        _gateway_mutex(),
+        _state_mutex(),
+        _state_changed(),
+        _task_mutex(),
+        _console_framer(),
+        _console_timer(),
+        _is_console_polled(false),
+        _tracer()
     {
-        register_commands();
-        _rx_thread = std::thread(rx_loop, this);
-        _tx_thread = std::thread(tx_loop, this);
-        _command_thread = std::thread(command_loop, this);
+        _reactor.set_wakeup_handler([this]
+        {
+            flush_tx(this);
+        });
+
+        _reactor.add(_connection.get_handle(), EPOLLIN, [this](kstd::u32 events)
+        {
+            handle_io(this, events);
+        });
+
+        _reactor.add(_tx_timer.get_handle(), EPOLLIN, [this](kstd::u32)
+        {
+            _tx_timer.acknowledge();
+            flush_tx(this);
+        });
+
+        _reactor.add(_ack_timer.get_handle(), EPOLLIN, [this](kstd::u32)
+        {
+            _ack_timer.acknowledge();
+            handle_ack_timeout(this);
+        });
+
+        _reactor.add(_negotiation_timer.get_handle(), EPOLLIN, [this](kstd::u32)
+        {
+            _negotiation_timer.acknowledge();
+            handle_negotiation_timeout(this);
+        });
+
+        if (_is_negotiating)
+        {
+            send_hello(this);
+        }
+
+        if (has_console)
+        {
+            open_console(this);
+        }
+
+        _io_thread.start([this]
+        {
+            io_loop(this);
+        });
     }
 
     Server::~Server() noexcept
     {
         _is_running = false;
-        _tx_thread.join();
-        _rx_thread.join();
-        _command_thread.join();
+        _reactor.stop();
+
+        // The reactor wakes up for the stop request, so this only fails if a handler is stuck
+        if (!_io_thread.join_for(THREAD_JOIN_TIMEOUT))
+        {
+            spdlog::critical("Serial IO thread did not stop in time, exiting");
+            spdlog::shutdown();
+            BoundedThread::abandon();
+        }
     }
 
-    auto Server::handle_feedback(Server* self, const std::string& feedback) noexcept -> void
+    auto Server::shutdown(std::chrono::milliseconds timeout) noexcept -> bool
     {
-        auto& state = self->_device_state;
+        set_is_on(false);
 
-        if (feedback == "power_on")
+        // Nothing can be drained once the device is gone, so don't wait for it
+        std::unique_lock lock(_state_mutex);
+        const auto is_drained = _state_changed.wait_for(lock, timeout, [this]
         {
-            state.actual_speed = 1;
-        }
-        else if (feedback == "power_off")
+            return !_is_connected || (_command_queue.was_empty() && !_is_tx_pending && _is_tx_idle && _num_in_flight == 0);
+        });
+
+        return is_drained && _is_connected;
+    }
+
+    auto Server::attach_gateway(Gateway* gateway) noexcept -> void
+    {
+        std::scoped_lock lock(_gateway_mutex);
+        _gateway = gateway;
+    }
+
+    auto Server::notify_state_changed(Server* self) noexcept -> void
+    {
         {
-            state.actual_speed = 0;
+            // Bumped under the lock so waiters can't miss the change between checking and waiting
+            std::scoped_lock lock(self->_state_mutex);
+            ++self->_device_state.version;
         }
-        else if (feedback == "speed_up")
+
+        self->_state_changed.notify_all();
+        std::scoped_lock lock(self->_gateway_mutex);
+
+        if (self->_gateway != nullptr)
         {
-            ++state.actual_speed;
+            self->_gateway->notify_state_changed();
         }
-        else if (feedback == "speed_down")
+    }
+
+    auto Server::update_num_in_flight(Server* self) noexcept -> void
+    {
+        const auto num_in_flight = self->_flow_control.get_num_in_flight();
+        metrics::serial_in_flight.set(num_in_flight);
+
+        // Whether commands are accepted depends on the number of in-flight messages
+        if (self->_num_in_flight.exchange(num_in_flight) != num_in_flight)
         {
-            --state.actual_speed;
+            notify_state_changed(self);
         }
     }
 
-    auto Server::tx_loop(Server* self) noexcept -> void
+    auto Server::set_actual_speed(Server* self, kstd::i32 speed) noexcept -> void
     {
-        using namespace std::chrono_literals;
-        spdlog::info("Starting serial TX thread");
+        if (self->_device_state.actual_speed.exchange(speed) == speed)
+        {
+            return;
+        }
 
-        while (self->_is_running)
+        if (speed == self->_device_state.target_speed)
         {
-            bool is_busy;
+            if (const auto start = self->_settle_start.exchange(0); start != 0)
             {
-                std::scoped_lock lock(self->_queue_mutex);
-                is_busy = !self->_message_queue.empty();
+                metrics::device_settle.observe(serial::Clock::now().time_since_epoch() - serial::Clock::duration(start));
             }
-            if (is_busy)
-            {
-                char message;
+        }
+
+        notify_state_changed(self);
+    }
+
+    auto Server::record_acknowledgement(Server* self, const serial::Acknowledgement& acknowledgement) noexcept -> void
+    {
+        const auto round_trip_time = acknowledgement.round_trip_time;
+        self->_tracer.record(acknowledgement.trace_id, TraceStage::ACKNOWLEDGED);
+        const auto sample = std::chrono::duration_cast<std::chrono::microseconds>(round_trip_time).count();
+        metrics::serial_round_trip.observe(round_trip_time);
+        const auto previous = self->_round_trip_time.load();
+        // Exponentially weighted moving average, like TCP's SRTT
+        self->_round_trip_time = previous == 0 ? sample : previous + (sample - previous) / 8;
+        update_num_in_flight(self);
+        spdlog::debug("Device acknowledged command after {}us", sample);
+    }
+
+    auto Server::resync_planner(Server* self) noexcept -> void
+    {
+        // Messages still in flight are part of what the planner assumes, so wait until they are answered or lost as well
+        if (!self->_is_planner_stale || self->_flow_control.get_num_in_flight() != 0)
+        {
+            return;
+        }
+
+        // The device is only powered off at speed 0
+        const kstd::i32 actual_speed = self->_device_state.actual_speed;
+        self->_planner.resync(actual_speed > 0, actual_speed);
+        self->_is_planner_stale = false;
+        spdlog::info("Replanning from actual speed {} after lost commands", actual_speed);
+    }
+
+    auto Server::handle_feedback(Server* self, Feedback feedback) noexcept -> void
+    {
+        auto& state = self->_device_state;
+        const auto now = serial::Clock::now();
+
+        if (const auto acknowledgement = self->_flow_control.on_acknowledged(serial::make_feedback_key(feedback), now))
+        {
+            record_acknowledgement(self, *acknowledgement);
+        }
+
+        switch (feedback)
+        {
+            case Feedback::POWER_ON:
+                set_actual_speed(self, 1);
+                break;
+            case Feedback::POWER_OFF:
+                set_actual_speed(self, 0);
+                break;
+            case Feedback::SPEED_UP:
+                set_actual_speed(self, state.actual_speed + 1);
+                break;
+            case Feedback::SPEED_DOWN:
+                set_actual_speed(self, state.actual_speed - 1);
+                break;
+            case Feedback::UNKNOWN:
+                break;
+        }
+
+        resync_planner(self);
+    }
+
+    auto Server::handle_frame(Server* self, const DecodedFrame& frame) noexcept -> void
+    {
+        const auto now = serial::Clock::now();
+
+        switch (frame.opcode)
+        {
+            case Opcode::HELLO_ACK:
+                if (!self->_is_negotiating)
                 {
-                    std::scoped_lock lock(self->_queue_mutex);
-                    message = self->_message_queue.front();
-                    self->_message_queue.pop();
+                    break;
                 }
 
-                if (!self->_connection.write(message))
+                self->_is_negotiating = false;
+                self->_protocol = Protocol::BINARY;
+                self->_negotiation_timer.disarm();
+                spdlog::info("Negotiated binary protocol version {} with {}", frame.payload.empty() ? 0 : frame.payload[0], self->_connection.get_device_name());
+                break;
+            case Opcode::ACK:
+                if (const auto acknowledgement = self->_flow_control.on_acknowledged(serial::make_sequence_key(frame.sequence), now))
                 {
-                    spdlog::warn("Dropped packet while sending, ignoring");
+                    record_acknowledgement(self, *acknowledgement);
+                }
+                [[fallthrough]];
+            case Opcode::STATE:
+                if (frame.payload.size() >= 1 + sizeof(kstd::i32))
+                {
+                    const auto is_on = frame.payload[0] != 0;
+                    set_actual_speed(self, is_on ? read_le<kstd::i32>(frame.payload.data() + 1) : 0);
                 }
 
-                const auto log_message = fmt::format("[Host -> {}] {}", self->_connection.get_device_name(), message);
-                spdlog::debug(log_message);
-
-                auto* monitor = self->_monitor;
+                resync_planner(self);
+                break;
+            case Opcode::NACK:
+            {
+                auto& connection = self->_connection;
+                const auto key = serial::make_sequence_key(frame.sequence);
 
-                if (monitor != nullptr)
+                if (!self->_flow_control.retransmit(key, now, [&connection](std::string_view packet) { connection.enqueue_bytes(packet); }))
                 {
-                    monitor->log_device(log_message);
+                    spdlog::warn("Device rejected frame #{} which can't be retransmitted", frame.sequence);
                 }
+                break;
             }
+            default:
+                spdlog::debug("Ignoring unexpected frame with opcode {:#04x}", static_cast<kstd::u8>(frame.opcode));
+                break;
+        }
+    }
 
-            std::this_thread::sleep_for(1ms);
+    auto Server::send_hello(Server* self) noexcept -> void
+    {
+        ++self->_num_negotiation_attempts;
+        self->_connection.enqueue_bytes(HELLO_FRAME.as_view());
+
+        if (const auto result = self->_connection.flush(); !result)
+        {
+            spdlog::error(result.error());
         }
+
+        self->_negotiation_timer.arm(NEGOTIATION_INTERVAL);
     }
 
-    auto Server::rx_loop(Server* self) noexcept -> void
+    auto Server::handle_negotiation_timeout(Server* self) noexcept -> void
     {
-        using namespace std::chrono_literals;
+        if (!self->_is_negotiating)
+        {
+            return;
+        }
 
-        spdlog::info("Starting serial RX thread");
-        std::vector<char> buffer;
+        if (self->_num_negotiation_attempts < NEGOTIATION_ATTEMPTS)
+        {
+            send_hello(self);
+            return;
+        }
+
+        spdlog::info("Device did not answer the binary handshake, falling back to legacy protocol");
+        self->_is_negotiating = false;
+        self->_rx_decoder.reset();
+        flush_tx(self);
+    }
+
+    auto Server::log_traffic(Server* self, bool is_outbound, std::string_view message) noexcept -> void
+    {
+        const auto& device_name = self->_connection.get_device_name();
+        const auto log_message = is_outbound ? fmt::format("[Host -> {}] {}", device_name, message) : fmt::format("[{} -> Host] {}", device_name, message);
+        spdlog::debug(log_message);
+
+        if (self->_monitor != nullptr)
+        {
+            self->_monitor->log_device(log_message);
+        }
+    }
+
+    auto Server::plan_next(Server* self, serial::Clock::time_point now) noexcept -> bool
+    {
+        auto& connection = self->_connection;
+        auto& planner = self->_planner;
+        auto& flow_control = self->_flow_control;
 
-        while (self->_is_running)
+        if (self->_protocol == Protocol::BINARY)
         {
-            char current = '\0';
-            buffer.clear();
+            const auto command = planner.next_command();
 
-            while (self->_connection.try_read(current))
+            if (!command)
             {
-                if (current == '\n')
-                {
-                    break;
-                }
+                return false;
+            }
+
+            const auto sequence = self->_tx_sequence++;
+            const auto frame = encode_command(*command, sequence);
+            connection.enqueue_bytes(frame.as_view());
+            flow_control.on_sent(serial::make_sequence_key(sequence), frame.as_view(), now, planner.get_trace_id());
+            self->_tracer.record(planner.get_trace_id(), TraceStage::SENT);
+            return true;
+        }
+
+        const auto message = planner.next_message();
+
+        if (!message)
+        {
+            return false;
+        }
+
+        connection.enqueue(*message);
+
+        flow_control.on_sent(serial::make_feedback_key(get_expected_feedback(*message)), std::string_view(&*message, 1), now, planner.get_trace_id());
+
+        self->_tracer.record(planner.get_trace_id(), TraceStage::SENT);
+
+        return true;
+    }
+
+    auto Server::enqueue_command(Server* self, Command command, kstd::u32 trace_id) noexcept -> void
+    {
+        if (!self->_is_connected)
+        {
+            spdlog::warn("{} is disconnected, dropping command", self->_connection.get_device_name());
+            return;
+        }
+
+        if (!self->_command_queue.try_push({command, trace_id}))
+        {
+            spdlog::warn("TX queue is full, dropping command");
+            return;
+        }
 
-                buffer.push_back(current);
+        metrics::tx_queue_depth.set(self->_command_queue.was_size());
+
+        // Only the first producer after a flush has to pay for the eventfd write
+        if (!self->_is_tx_pending.exchange(true))
+        {
+            self->_reactor.wakeup();
+        }
+    }
+
+    auto Server::flush_tx(Server* self) noexcept -> void
+    {
+        self->_is_tx_pending = false;
+
+        if (!self->_is_connected)
+        {
+            return;
+        }
+
+        auto& connection = self->_connection;
+        auto& planner = self->_planner;
+        auto& pacer = self->_pacer;
+        QueuedCommand queued{};
+
+        while (self->_command_queue.try_pop(queued))
+        {
+            planner.apply(queued.command, queued.trace_id);
+        }
+
+        metrics::tx_queue_depth.set(0);
+
+        const auto now = serial::Clock::now();
+
+        auto& flow_control = self->_flow_control;
+
+        // Only plan new messages once the previous batch has been accepted by the kernel,
+        // and not before it is known which protocol the device speaks
+        if (!connection.has_pending() && !self->_is_negotiating)
+        {
+            const auto num_available = std::min(pacer.get_available(now), flow_control.get_credits());
+            kstd::u32 num_messages = 0;
+
+            for (; num_messages < num_available && plan_next(self, now); ++num_messages)
+            {
             }
 
-            if (!buffer.empty())
+            pacer.commit(now, num_messages);
+
+            if (num_messages > 0)
             {
-                buffer.push_back('\0');
+                metrics::serial_commands_sent.add(num_messages);
+                update_num_in_flight(self);
+                update_ack_timer(self, now);
+            }
 
-                auto feedback = std::string(buffer.data());
-                if (feedback.ends_with('\r'))
+            if (num_messages > 0 && (spdlog::should_log(spdlog::level::debug) || self->_monitor != nullptr))
+            {
+                const auto pending = connection.get_pending();
+
+                if (self->_protocol == Protocol::BINARY)
+                {
+                    log_traffic(self, true, fmt::format("{:02x}", fmt::join(pending, " ")));
+                }
+                else
                 {
-                    feedback = feedback.substr(0, feedback.size() - 1);
+                    log_traffic(self, true, pending);
                 }
+            }
+        }
 
-                handle_feedback(self, feedback);
+        const auto num_pending = connection.get_pending().size();
 
-                const auto log_message = fmt::format("[{} -> Host] {}", self->_connection.get_device_name(), feedback);
-                spdlog::debug(log_message);
+        if (const auto result = connection.flush(); !result)
+        {
+            spdlog::error(result.error());
+        }
+        else
+        {
+            metrics::serial_tx_bytes.add(num_pending - connection.get_pending().size());
+        }
 
-                auto* monitor = self->_monitor;
+        // Partial writes are resumed as soon as the handle becomes writable again
+        if (const auto is_blocked = connection.has_pending(); is_blocked != self->_is_tx_blocked)
+        {
+            self->_reactor.modify(connection.get_handle(), is_blocked ? EPOLLIN | EPOLLOUT : EPOLLIN);
+            self->_is_tx_blocked = is_blocked;
+        }
 
-                if (monitor != nullptr)
-                {
-                    monitor->log_device(log_message);
-                }
+        // Without credits the next acknowledgement triggers the flush instead
+        if (planner.has_pending() && flow_control.get_credits() > 0 && !self->_is_negotiating)
+        {
+            self->_tx_timer.arm(pacer.get_delay(now));
+        }
+
+        if (const auto is_idle = !planner.has_pending() && !connection.has_pending(); is_idle != self->_is_tx_idle)
+        {
+            {
+                // Updated under the lock so a draining shutdown can't miss it
+                std::scoped_lock lock(self->_state_mutex);
+                self->_is_tx_idle = is_idle;
             }
 
-            std::this_thread::sleep_for(1ms);
+            self->_state_changed.notify_all();
+        }
+    }
+
+    auto Server::handle_ack_timeout(Server* self) noexcept -> void
+    {
+        auto& connection = self->_connection;
+        const auto now = serial::Clock::now();
+
+        const auto num_dropped = self->_flow_control.collect_expired(now, [&connection](std::string_view packet)
+        {
+            spdlog::debug("Retransmitting unacknowledged command {:02x}", fmt::join(packet, " "));
+            connection.enqueue_bytes(packet);
+            metrics::serial_retransmits.add();
+        });
+
+        if (num_dropped > 0)
+        {
+            metrics::serial_commands_lost.add(num_dropped);
+            spdlog::warn("Device did not acknowledge {} commands, giving up on them", num_dropped);
+            self->_is_planner_stale = true;
+        }
+
+        update_num_in_flight(self);
+        resync_planner(self);
+        update_ack_timer(self, now);
+        flush_tx(self);
+    }
+
+    auto Server::update_ack_timer(Server* self, serial::Clock::time_point now) noexcept -> void
+    {
+        const auto deadline = self->_flow_control.get_next_deadline();
+
+        if (!deadline)
+        {
+            self->_ack_timer.disarm();
+            return;
+        }
+
+        self->_ack_timer.arm(*deadline > now ? *deadline - now : serial::Clock::duration::zero());
+    }
+
+    auto Server::handle_io(Server* self, kstd::u32 events) noexcept -> void
+    {
+        if ((events & (EPOLLHUP | EPOLLERR)) != 0)
+        {
+            spdlog::error("Lost connection to {}", self->_connection.get_device_name());
+            handle_device_lost(self);
+            return;
+        }
+
+        if ((events & EPOLLOUT) != 0)
+        {
+            flush_tx(self);
+        }
+
+        if ((events & EPOLLIN) != 0)
+        {
+            handle_rx(self);
         }
     }
 
-    auto Server::command_loop(Server* self) noexcept -> void
+    auto Server::handle_device_lost(Server* self) noexcept -> void
+    {
+        self->_reactor.remove(self->_connection.get_handle());
+        self->_tx_timer.disarm();
+        self->_ack_timer.disarm();
+        self->_negotiation_timer.disarm();
+        self->_lifecycle.request_shutdown("serial device lost");
+        self->_is_connected = false;
+        notify_state_changed(self);
+    }
+
+    auto Server::handle_rx(Server* self) noexcept -> void
     {
-        spdlog::info("Starting command thread");
-        std::string command;
+        // The handshake reply is already framed, so listen for frames while negotiating
+        if (self->_protocol == Protocol::BINARY || self->_is_negotiating)
+        {
+            handle_rx_frames(self);
+            return;
+        }
+
+        auto& framer = self->_rx_framer;
+        const auto result = framer.read_from(self->_connection.get_handle());
+
+        if (result > 0)
+        {
+            metrics::serial_rx_bytes.add(static_cast<kstd::u64>(result));
+        }
 
-        while (self->_is_running)
+        // Hangups are reported through EPOLLHUP, a zero result only means there was nothing to read
+        if (result == -1 && errno != EAGAIN && errno != EINTR)
         {
-            std::getline(std::cin, command);
+            spdlog::error("Could not read from {}: {}", self->_connection.get_device_name(), kstd::platform::get_last_error());
+            handle_device_lost(self);
+            return;
+        }
+
+        const auto should_log = spdlog::should_log(spdlog::level::debug) || self->_monitor != nullptr;
 
-            if (command.empty())
+        while (const auto line = framer.next_line())
+        {
+            if (line->empty())
             {
                 continue;
             }
 
-            const auto itr = self->_commands.find(command);
+            handle_feedback(self, parse_feedback(*line));
 
-            if (itr == self->_commands.end())
+            if (should_log)
             {
-                spdlog::info("Unrecognized command, try help");
-                continue;
+                log_traffic(self, false, *line);
             }
+        }
 
-            itr->second();
+        // Acknowledgements free up credits for commands which are still waiting
+        if (self->_planner.has_pending())
+        {
+            flush_tx(self);
         }
     }
 
-    auto Server::register_commands() noexcept -> void
+    auto Server::handle_rx_frames(Server* self) noexcept -> void
     {
-        _commands["help"] = [this]
+        std::array<kstd::u8, RX_BUFFER_SIZE> buffer{};
+        const auto result = ::read(self->_connection.get_handle(), buffer.data(), buffer.size());
+
+        if (result == -1 && errno != EAGAIN && errno != EINTR)
         {
-            for (const auto& pair : _commands)
-            {
-                spdlog::info(pair.first);
-            }
-        };
+            spdlog::error("Could not read from {}: {}", self->_connection.get_device_name(), kstd::platform::get_last_error());
+            handle_device_lost(self);
+            return;
+        }
+
+        if (result <= 0)
+        {
+            return;
+        }
+
+        metrics::serial_rx_bytes.add(static_cast<kstd::u64>(result));
+        const auto data = std::span<const kstd::u8>(buffer.data(), static_cast<kstd::usize>(result));
+
+        if (spdlog::should_log(spdlog::level::debug) || self->_monitor != nullptr)
+        {
+            log_traffic(self, false, fmt::format("{:02x}", fmt::join(data, " ")));
+        }
+
+        auto& decoder = self->_rx_decoder;
+        const auto num_corrupted = decoder.get_num_corrupted();
+
+        decoder.feed(data, [self](const DecodedFrame& frame)
+        {
+            handle_frame(self, frame);
+        });
 
-        _commands["exit"] = [this]
+        if (decoder.get_num_corrupted() != num_corrupted)
         {
-            spdlog::info("Shutting down gracefully");
+            spdlog::warn("Discarded {} corrupted frames from {}", decoder.get_num_corrupted() - num_corrupted, self->_connection.get_device_name());
+        }
+
+        // Covers the handshake completing as well as acknowledgements freeing up credits
+        flush_tx(self);
+    }
+
+    auto Server::io_loop(Server* self) noexcept -> void
+    {
+        spdlog::info("Starting serial IO thread");
+        self->_reactor.run();
+    }
+
+    auto Server::open_console(Server* self) noexcept -> void
+    {
+        struct stat status{};
+
+        if (::fstat(STDIN_FILENO, &status) != 0)
+        {
+            spdlog::debug("No console input available");
+            return;
+        }
+
+        // Regular files and devices like /dev/null are rejected by epoll, but never block either
+        self->_is_console_polled = !S_ISFIFO(status.st_mode) && !S_ISSOCK(status.st_mode) && ::isatty(STDIN_FILENO) != 1;
 
-            if (_device_state.is_on)
+        if (self->_is_console_polled)
+        {
+            self->_reactor.add(self->_console_timer.get_handle(), EPOLLIN, [self](kstd::u32)
             {
-                std::scoped_lock lock(_queue_mutex);
-                _message_queue.push(MESSAGE_OFF);
-                _device_state.is_on = false;
-            }
+                self->_console_timer.acknowledge();
+                handle_console(self);
+            });
 
-            if (_monitor != nullptr && _monitor->is_running())
+            self->_console_timer.arm(std::chrono::nanoseconds::zero());
+        }
+        else
+        {
+            self->_reactor.add(STDIN_FILENO, EPOLLIN, [self](kstd::u32)
             {
-                _monitor->request_close();
-            }
+                handle_console(self);
+            });
+        }
+    }
 
-            _is_running = false;
-        };
+    auto Server::close_console(Server* self) noexcept -> void
+    {
+        if (self->_is_console_polled)
+        {
+            self->_console_timer.disarm();
+            self->_reactor.remove(self->_console_timer.get_handle());
+        }
+        else
+        {
+            self->_reactor.remove(STDIN_FILENO);
+        }
+
+        spdlog::debug("Console input closed");
+    }
+
+    auto Server::handle_console(Server* self) noexcept -> void
+    {
+        auto& framer = self->_console_framer;
+        const auto result = framer.read_from(STDIN_FILENO);
 
-        _commands["power"] = [this]
+        if (result == -1 && (errno == EAGAIN || errno == EINTR))
         {
-            spdlog::info("Requesting change of power status");
-            set_is_on(!_device_state.is_on);
-        };
+            return;
+        }
 
-        _commands["mode"] = [this]
+        if (result == -1)
         {
-            if (!_device_state.is_on)
-            {
-                spdlog::info("This command only works if the machine is on");
-                return;
-            }
+            spdlog::error("Could not read console input: {}", kstd::platform::get_last_error());
+        }
 
-            spdlog::info("Requesting change of mode");
-            set_mode(dto::Mode::DEFAULT); // TODO: implement mode selection
-        };
+        while (const auto line = framer.next_line())
+        {
+            run_command(self, *line);
+        }
 
-        _commands["lower"] = [this]
+        if (result <= 0)
         {
-            const auto speed = get_target_speed();
+            close_console(self);
+            return;
+        }
 
-            if (!_device_state.is_on || speed == 0)
-            {
-                spdlog::info("This command only works if the machine is on and if the speed is > 0");
-                return;
-            }
+        // Read the next slice of a script on the next turn, so serial IO is never held up by it
+        if (self->_is_console_polled)
+        {
+            self->_console_timer.arm(std::chrono::nanoseconds::zero());
+        }
+    }
 
-            spdlog::info("Requesting change of speed");
-            const auto new_speed = speed - 1;
-            set_speed(new_speed);
+    auto Server::run_command(Server* self, std::string_view line) noexcept -> void
+    {
+        const auto is_space = [](char c)
+        {
+            return c == ' ' || c == '\t';
         };
 
-        _commands["higher"] = [this]
+        while (!line.empty() && is_space(line.front()))
+        {
+            line.remove_prefix(1);
+        }
+
+        while (!line.empty() && is_space(line.back()))
         {
-            const auto speed = get_target_speed();
+            line.remove_suffix(1);
+        }
+
+        // Lets scripts carry comments
+        if (line.empty() || line.front() == '#')
+        {
+            return;
+        }
 
-            if (!_device_state.is_on || speed == MAX_SPEED)
+        const auto name = line.substr(0, line.find_first_of(" \t"));
+        auto arguments = line.substr(name.size());
+
+        while (!arguments.empty() && is_space(arguments.front()))
+        {
+            arguments.remove_prefix(1);
+        }
+
+        for (const auto& command : get_commands())
+        {
+            if (command.name == name)
             {
-                spdlog::info("This command only works if the machine is on and the speed is < MAX_SPEED");
+                command.handler(self, arguments);
                 return;
             }
+        }
+
+        spdlog::info("Unrecognized command {}, try help", name);
+    }
+
+    auto Server::get_commands() noexcept -> std::span<const ConsoleCommand>
+    {
+        static constexpr ConsoleCommand commands[] = {
+            {"help", "", "Lists all commands", [](Server*, std::string_view) noexcept
+            {
+                for (const auto& command : get_commands())
+                {
+                    spdlog::info("{:<8}{:<12}{}", command.name, command.arguments, command.description);
+                }
+            }},
+            {"exit", "", "Powers the device off and shuts down", [](Server* self, std::string_view) noexcept
+            {
+                self->_lifecycle.request_shutdown("exit command");
+            }},
+            {"power", "[on|off]", "Switches the device on or off, toggles without an argument", [](Server* self, std::string_view arguments) noexcept
+            {
+                if (!arguments.empty() && arguments != "on" && arguments != "off")
+                {
+                    spdlog::info("Usage: power [on|off]");
+                    return;
+                }
+
+                spdlog::info("Requesting change of power status");
+                self->set_is_on(arguments.empty() ? !self->_device_state.is_on : arguments == "on");
+            }},
+            {"speed", "<speed>", "Sets the target speed, powering the device on or off as needed", [](Server* self, std::string_view arguments) noexcept
+            {
+                kstd::i32 speed = 0;
+                const auto [end, error] = std::from_chars(arguments.data(), arguments.data() + arguments.size(), speed);
+
+                if (arguments.empty() || error != std::errc() || end != arguments.data() + arguments.size() || speed < dto::MIN_SPEED || speed > dto::MAX_SPEED)
+                {
+                    spdlog::info("Usage: speed <{}-{}>", dto::MIN_SPEED, dto::MAX_SPEED);
+                    return;
+                }
+
+                self->set_speed(speed);
+            }},
+            {"lower", "", "Lowers the speed by one step", [](Server* self, std::string_view) noexcept
+            {
+                const auto speed = self->get_target_speed();
 
-            spdlog::info("Requesting change of speed");
-            const auto new_speed = speed + 1;
-            set_speed(new_speed);
+                if (!self->_device_state.is_on || speed == 0)
+                {
+                    spdlog::info("This command only works if the machine is on and if the speed is > 0");
+                    return;
+                }
+
+                spdlog::info("Requesting change of speed");
+                self->set_speed(speed - 1);
+            }},
+            {"higher", "", "Raises the speed by one step", [](Server* self, std::string_view) noexcept
+            {
+                const auto speed = self->get_target_speed();
+
+                if (!self->_device_state.is_on || speed == dto::MAX_SPEED)
+                {
+                    spdlog::info("This command only works if the machine is on and the speed is < MAX_SPEED");
+                    return;
+                }
+
+                spdlog::info("Requesting change of speed");
+                self->set_speed(speed + 1);
+            }},
+            {"mode", "[name]", "Selects a mode by name, the default mode without an argument", [](Server* self, std::string_view arguments) noexcept
+            {
+                if (!self->_device_state.is_on)
+                {
+                    spdlog::info("This command only works if the machine is on");
+                    return;
+                }
+
+                const auto is_same_name = [arguments](dto::Mode mode)
+                {
+                    const auto name = get_mode_name(mode);
+
+                    return std::equal(name.begin(), name.end(), arguments.begin(), arguments.end(), [](char a, char b)
+                    {
+                        return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                    });
+                };
+
+                const auto* const itr = arguments.empty() ? std::begin(MODES) : std::find_if(std::begin(MODES), std::end(MODES), is_same_name);
+
+                if (itr == std::end(MODES))
+                {
+                    spdlog::info("Unknown mode {}", arguments);
+                    return;
+                }
+
+                spdlog::info("Requesting change of mode");
+                self->set_mode(*itr);
+            }},
+            {"stats", "", "Prints the state of the device, of the serial link and all metrics", [](Server* self, std::string_view) noexcept
+            {
+                spdlog::info("Device is {}, target speed {}, actual speed {}, mode {}", self->is_on() ? "on" : "off", self->get_target_speed(), self->get_actual_speed(), get_mode_name(self->get_mode()));
+                spdlog::info("{} protocol, {} commands in flight, round trip time {}us, state version {}", self->get_protocol() == Protocol::BINARY ? "Binary" : "Legacy", self->get_num_in_flight(), self->get_round_trip_time().count(), self->get_state_version());
+
+                std::string summary;
+                write_metric_summary(summary);
+                std::string_view lines(summary);
+
+                while (!lines.empty())
+                {
+                    const auto end = lines.find('\n');
+                    spdlog::info(lines.substr(0, end));
+                    lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+                }
+            }},
+            {"trace", "[path]", "Prints the command latency percentiles, with a path also exports the recent traces as Chrome trace JSON", [](Server* self, std::string_view arguments) noexcept
+            {
+                std::string report;
+                self->_tracer.write_latency_report(report);
+                std::string_view lines(report);
+
+                while (!lines.empty())
+                {
+                    const auto end = lines.find('\n');
+                    spdlog::info(lines.substr(0, end));
+                    lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+                }
+
+                if (arguments.empty())
+                {
+                    return;
+                }
+
+                std::string trace;
+                self->_tracer.write_chrome_trace(trace);
+                std::ofstream file{std::string(arguments), std::ios::binary | std::ios::trunc};
+
+                if (!file.write(trace.data(), static_cast<std::streamsize>(trace.size())))
+                {
+                    spdlog::error("Could not write traces to {}", arguments);
+                    return;
+                }
+
+                spdlog::info("Wrote {} bytes of traces to {}", trace.size(), arguments);
+            }}
         };
+
+        return commands;
     }
 
-    auto Server::set_speed(kstd::i32 speed) noexcept -> void
+    auto Server::set_speed(kstd::i32 speed, kstd::u32 trace_id) noexcept -> void
     {
         if (!_device_state.is_on && speed > 0)
         {
-            set_is_on(true);
+            set_is_on(true, trace_id);
         }
         else if (_device_state.is_on && speed == 0)
         {
-            set_is_on(false);
+            set_is_on(false, trace_id);
             return;
         }
 
-        if (_device_state.target_speed < speed)
+        if (_device_state.target_speed != speed)
         {
-            const auto diff = speed - _device_state.target_speed;
-
-            for (auto i = 0; i < diff; ++i)
-            {
-                std::scoped_lock lock(_queue_mutex);
-                _message_queue.push(MESSAGE_HIGHER);
-            }
-        }
-        else if (_device_state.target_speed > speed)
-        {
-            const auto diff = _device_state.target_speed - speed;
-
-            for (auto i = 0; i < diff; ++i)
-            {
-                std::scoped_lock lock(_queue_mutex);
-                _message_queue.push(MESSAGE_LOWER);
-            }
+            _settle_start = serial::Clock::now().time_since_epoch().count();
+            enqueue_command(this, {CommandType::SPEED, speed}, trace_id);
         }
 
         if (_monitor != nullptr)
@@ -291,23 +955,22 @@ namespace fox
         }
 
         _device_state.target_speed = speed;
+        notify_state_changed(this);
     }
 
-    auto Server::set_is_on(bool is_on) noexcept -> void
+    auto Server::set_is_on(bool is_on, kstd::u32 trace_id) noexcept -> void
     {
         if (_device_state.is_on == is_on)
         {
             return;
         }
 
-        {
-            std::scoped_lock lock(_queue_mutex);
-            _message_queue.push(is_on ? MESSAGE_ON : MESSAGE_OFF);
-        }
-
+        _settle_start = serial::Clock::now().time_since_epoch().count();
+        enqueue_command(this, {CommandType::POWER, is_on ? 1 : 0}, trace_id);
         _device_state.is_on = is_on;
         const auto new_speed = is_on ? 1 : 0;
         _device_state.target_speed = new_speed;
+        notify_state_changed(this);
 
         if (_monitor != nullptr)
         {
@@ -323,5 +986,60 @@ namespace fox
         }
 
         _device_state.mode = mode;
+        notify_state_changed(this);
+    }
+
+    auto Server::apply_tasks(std::span<const dto::Task> tasks, TraceClock::time_point received_at) noexcept -> kstd::usize
+    {
+        // The snapshot must not change between reducing a batch and applying it
+        std::scoped_lock lock(_task_mutex);
+        thread_local std::vector<dto::Task> reduced;
+        reduce_tasks({is_on(), get_target_speed(), get_mode()}, tasks, reduced);
+        metrics::tasks_received.add(tasks.size());
+        metrics::tasks_applied.add(reduced.size());
+
+        for (const auto& task : reduced)
+        {
+            const auto trace_id = _tracer.begin(to_command(task), received_at);
+            _tracer.record(trace_id, TraceStage::APPLIED);
+
+            switch (dto::get_task_type(task))
+            {
+                case dto::TaskType::POWER:
+                    set_is_on(std::get<dto::PowerTask>(task).is_on, trace_id);
+                    break;
+                case dto::TaskType::SPEED:
+                    set_speed(std::get<dto::SpeedTask>(task).speed, trace_id);
+                    break;
+                case dto::TaskType::MODE:
+                    // Mode changes are not sent to the device, their trace ends here
+                    set_mode(std::get<dto::ModeTask>(task).mode);
+                    break;
+            }
+        }
+
+        return reduced.size();
+    }
+
+    auto Server::wait_for_state_change(kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> kstd::u64
+    {
+        std::unique_lock lock(_state_mutex);
+        _state_changed.wait_for(lock, timeout, [this, version]
+        {
+            return _device_state.version != version;
+        });
+
+        return _device_state.version;
+    }
+
+    auto Server::get_state_snapshot() const noexcept -> dto::DeviceState
+    {
+        dto::DeviceState state{};
+        state.is_on = is_on();
+        state.accepts_commands = accepts_commands();
+        state.target_speed = get_target_speed();
+        state.actual_speed = get_actual_speed();
+        state.mode = get_mode();
+        return state;
     }
 }
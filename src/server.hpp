@@ -5,26 +5,33 @@
 
 #pragma once
 
+#include <span>
 #include <atomic>
 #include <mutex>
-#include <queue>
-#include <functional>
-#include <parallel_hashmap/phmap.h>
+#include <condition_variable>
+#include <string_view>
 #include <atomic_queue/atomic_queue.h>
 #include <kstd/types.hpp>
 #include <mutex>
 #include "serial.hpp"
+#include "pacing.hpp"
+#include "flow_control.hpp"
+#include "reactor.hpp"
+#include "framer.hpp"
+#include "protocol.hpp"
+#include "planner.hpp"
 #include "dto.hpp"
+#include "lifecycle.hpp"
+#include "trace.hpp"
 
 namespace fox {
-    constexpr char MESSAGE_ON = 'i';
-    constexpr char MESSAGE_OFF = 'o';
-    constexpr char MESSAGE_MODE = 'm';
-    constexpr char MESSAGE_LOWER = 'l';
-    constexpr char MESSAGE_HIGHER = 'h';
-
-    constexpr int32_t MAX_SPEED = 32;
-    constexpr int32_t MIN_SPEED = 0;
+    constexpr kstd::usize RX_BUFFER_SIZE = 256;
+    constexpr kstd::u32 TX_QUEUE_CAPACITY = 1024;
+    constexpr kstd::u32 NEGOTIATION_ATTEMPTS = 8; // Covers the bootloader delay of auto-resetting boards
+    constexpr std::chrono::milliseconds NEGOTIATION_INTERVAL(250);
+    constexpr std::chrono::milliseconds SHUTDOWN_DRAIN_TIMEOUT(1500);
+    constexpr kstd::usize CONSOLE_BUFFER_SIZE = 256;
+
     constexpr dto::Mode MODES[] = {dto::Mode::DEFAULT};
     constexpr size_t NUM_MODES = sizeof(MODES);
 
@@ -40,51 +47,191 @@ namespace fox {
         std::atomic<dto::Mode> mode;
         std::atomic_int32_t target_speed;
         std::atomic_int32_t actual_speed;
+        std::atomic_uint64_t version; // Bumped after every change of the observable state
     };
 
     class Monitor;
 
+    class Gateway;
+
+    class Server;
+
+    struct QueuedCommand final {
+        Command command;
+        kstd::u32 trace_id;
+    };
+
+    struct ConsoleCommand final {
+        std::string_view name;
+        std::string_view arguments;
+        std::string_view description;
+        void (*handler)(Server* self, std::string_view arguments) noexcept;
+    };
+
     class Server final {
         serial::SerialConnection _connection;
+        Lifecycle& _lifecycle;
         Monitor* _monitor;
-        std::thread _tx_thread;
-        std::thread _rx_thread;
-        std::thread _command_thread;
+        Reactor _reactor;
+        BoundedThread _io_thread;
         std::atomic_bool _is_running;
         std::atomic_bool _is_busy;
+        std::atomic_bool _is_connected; // Cleared for good once the device hung up or can't be read anymore
         DeviceState _device_state;
-        phmap::parallel_flat_hash_map<std::string, std::function<void()>> _commands;
-        std::queue<char> _message_queue;
-        std::mutex _queue_mutex;
+        atomic_queue::AtomicQueue2<QueuedCommand, TX_QUEUE_CAPACITY> _command_queue;
+        std::atomic_bool _is_tx_pending;
+        std::atomic_bool _is_tx_idle; // Nothing is left to plan or write, only maintained on the reactor thread
+        std::atomic<serial::Clock::rep> _settle_start; // When the target speed last changed, 0 once the device reached it
+        SpeedPlanner _planner;
+        bool _is_planner_stale; // Messages were lost, so the planner has to catch up with the device once the link is quiet
+        serial::Pacer _pacer;
+        Timer _tx_timer;
+        bool _is_tx_blocked;
+        serial::FlowControl _flow_control;
+        Timer _ack_timer;
+        std::atomic<kstd::u32> _num_in_flight;
+        std::atomic<kstd::i64> _round_trip_time;
+        LineFramer<RX_BUFFER_SIZE> _rx_framer;
+        FrameDecoder _rx_decoder;
+        std::atomic<Protocol> _protocol;
+        bool _is_negotiating;
+        kstd::u32 _num_negotiation_attempts;
+        Timer _negotiation_timer;
+        kstd::u8 _tx_sequence;
+        Gateway* _gateway;
+        std::mutex _gateway_mutex;
+        std::mutex _state_mutex;
+        std::condition_variable _state_changed;
+        std::mutex _task_mutex;
+        LineFramer<CONSOLE_BUFFER_SIZE> _console_framer;
+        Timer _console_timer;
+        bool _is_console_polled; // Regular files and the like can't be watched with epoll, they are read in slices instead
+        CommandTracer _tracer;
+
+        static auto notify_state_changed(Server* self) noexcept -> void;
+
+        static auto update_num_in_flight(Server* self) noexcept -> void;
+
+        static auto set_actual_speed(Server* self, kstd::i32 speed) noexcept -> void;
+
+        static auto record_acknowledgement(Server* self, const serial::Acknowledgement& acknowledgement) noexcept -> void;
+
+        static auto resync_planner(Server* self) noexcept -> void;
+
+        static auto handle_feedback(Server* self, Feedback feedback) noexcept -> void;
+
+        static auto handle_frame(Server* self, const DecodedFrame& frame) noexcept -> void;
+
+        static auto send_hello(Server* self) noexcept -> void;
+
+        static auto handle_negotiation_timeout(Server* self) noexcept -> void;
+
+        static auto plan_next(Server* self, serial::Clock::time_point now) noexcept -> bool;
+
+        static auto enqueue_command(Server* self, Command command, kstd::u32 trace_id) noexcept -> void;
+
+        static auto flush_tx(Server* self) noexcept -> void;
+
+        static auto handle_ack_timeout(Server* self) noexcept -> void;
+
+        static auto update_ack_timer(Server* self, serial::Clock::time_point now) noexcept -> void;
+
+        static auto handle_io(Server* self, kstd::u32 events) noexcept -> void;
 
-        static auto handle_feedback(Server* self, const std::string& feedback) noexcept -> void;
+        static auto handle_device_lost(Server* self) noexcept -> void;
 
-        static auto tx_loop(Server* self) noexcept -> void;
+        static auto handle_rx(Server* self) noexcept -> void;
 
-        static auto rx_loop(Server* self) noexcept -> void;
+        static auto handle_rx_frames(Server* self) noexcept -> void;
 
-        static auto command_loop(Server* self) noexcept -> void;
+        static auto log_traffic(Server* self, bool is_outbound, std::string_view message) noexcept -> void;
 
-        auto register_commands() noexcept -> void;
+        static auto io_loop(Server* self) noexcept -> void;
+
+        static auto open_console(Server* self) noexcept -> void;
+
+        static auto close_console(Server* self) noexcept -> void;
+
+        /**
+         * Reads the next slice of console input and runs every complete command line in it.
+         */
+        static auto handle_console(Server* self) noexcept -> void;
+
+        static auto run_command(Server* self, std::string_view line) noexcept -> void;
+
+        [[nodiscard]] static auto get_commands() noexcept -> std::span<const ConsoleCommand>;
 
         public:
 
-        Server(std::string device_name, kstd::u32 baud_rate) noexcept;
+        /**
+         * @param has_console False if commands are never read from stdin, like when embedded in tests.
+         */
+        Server(Lifecycle& lifecycle, std::string device_name, kstd::u32 baud_rate, const serial::PacingPolicy& pacing, const serial::FlowControlPolicy& flow_control, bool negotiate_binary, bool has_console) noexcept;
 
         ~Server() noexcept;
 
-        auto set_speed(kstd::i32 speed) noexcept -> void;
+        /**
+         * Powers the device off and waits until every queued command has been
+         * written and acknowledged, or the timeout ran out.
+         * @return False if commands were still pending when the timeout ran out.
+         */
+        auto shutdown(std::chrono::milliseconds timeout) noexcept -> bool;
+
+        auto set_speed(kstd::i32 speed, kstd::u32 trace_id = NO_TRACE) noexcept -> void;
 
-        auto set_is_on(bool is_on) noexcept -> void;
+        auto set_is_on(bool is_on, kstd::u32 trace_id = NO_TRACE) noexcept -> void;
 
         auto set_mode(dto::Mode mode) noexcept -> void;
 
+        /**
+         * Applies the net change of a batch of tasks, see reduce_tasks. Batches
+         * from different sources are applied one after another. Every applied
+         * task starts a trace, see get_tracer.
+         * @param received_at When the tasks arrived, the start of their traces.
+         * @return The number of tasks which were actually applied.
+         */
+        auto apply_tasks(std::span<const dto::Task> tasks, TraceClock::time_point received_at = TraceClock::now()) noexcept -> kstd::usize;
+
+        /**
+         * Blocks until the state version differs from the given one or the timeout ran out.
+         * @return The current state version.
+         */
+        auto wait_for_state_change(kstd::u64 version, std::chrono::milliseconds timeout) noexcept -> kstd::u64;
+
+        [[nodiscard]] auto get_state_snapshot() const noexcept -> dto::DeviceState;
+
         inline auto attach_monitor(Monitor* monitor) noexcept -> void {
             _monitor = monitor;
         }
 
+        /**
+         * Registers the gateway to be notified about state changes, pass
+         * nullptr to detach it. Once this returns, no notification for a
+         * previously attached gateway is in progress anymore.
+         */
+        auto attach_gateway(Gateway* gateway) noexcept -> void;
+
         [[nodiscard]] inline auto accepts_commands() const noexcept -> bool {
-            return _device_state.actual_speed == _device_state.target_speed;
+            return _is_connected && _device_state.actual_speed == _device_state.target_speed && _num_in_flight == 0;
+        }
+
+        [[nodiscard]] inline auto get_protocol() const noexcept -> Protocol {
+            return _protocol;
+        }
+
+        [[nodiscard]] inline auto get_num_in_flight() const noexcept -> kstd::u32 {
+            return _num_in_flight;
+        }
+
+        /**
+         * @return The smoothed time between sending a command and its acknowledgement by the device.
+         */
+        [[nodiscard]] inline auto get_round_trip_time() const noexcept -> std::chrono::microseconds {
+            return std::chrono::microseconds(_round_trip_time.load());
+        }
+
+        [[nodiscard]] inline auto get_tracer() const noexcept -> const CommandTracer& {
+            return _tracer;
         }
 
         [[nodiscard]] inline auto get_connection() noexcept -> serial::SerialConnection& {
@@ -95,6 +242,10 @@ namespace fox {
             return _is_running;
         }
 
+        [[nodiscard]] inline auto is_connected() const noexcept -> bool {
+            return _is_connected;
+        }
+
         [[nodiscard]] inline auto is_busy() const noexcept -> bool {
             return _is_busy;
         }
@@ -114,5 +265,13 @@ namespace fox {
         [[nodiscard]] inline auto get_mode() const noexcept -> dto::Mode {
             return _device_state.mode;
         }
+
+        /**
+         * @return A counter which changes whenever any value reported
+         *  to the gateway may have changed, starting at zero.
+         */
+        [[nodiscard]] inline auto get_state_version() const noexcept -> kstd::u64 {
+            return _device_state.version;
+        }
     };
 }
\ No newline at end of file
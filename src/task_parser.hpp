@@ -0,0 +1,411 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+#include <variant>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <nlohmann/json.hpp>
+#include <kstd/types.hpp>
+#include "dto.hpp"
+#include "reflect.hpp"
+#include "wire_format.hpp"
+
+namespace fox {
+    template<typename V>
+    struct TaskKeys;
+
+    /**
+     * The keys a task object may contain: "type" followed by the field names of
+     * all task types. A name shared by several task types maps to its first slot.
+     */
+    template<typename... T>
+    struct TaskKeys<std::variant<T...>> final {
+        static constexpr kstd::usize SIZE = 1 + (get_num_fields<T>() + ...);
+        static constexpr kstd::usize TYPE_SLOT = 0;
+        static constexpr kstd::usize NO_SLOT = SIZE;
+
+        static constexpr auto NAMES = [] {
+            std::array<std::string_view, SIZE> names{"type"};
+            kstd::usize index = 1;
+
+            (for_each_field<T>([&names, &index](const auto& field) {
+                names[index++] = field.name;
+            }), ...);
+
+            return names;
+        }();
+
+        [[nodiscard]] static constexpr auto find_slot(std::string_view name) noexcept -> kstd::usize {
+            for (kstd::usize index = 0; index < SIZE; ++index) {
+                if (NAMES[index] == name) {
+                    return index;
+                }
+            }
+
+            return NO_SLOT;
+        }
+    };
+
+    using TaskKeySet = TaskKeys<dto::Task>;
+
+    struct TaskError final {
+        kstd::usize index;
+        const char* reason;
+        std::string_view field; // Empty if the error is not about a single field
+    };
+
+    /**
+     * SAX handler turning a task list straight into dto::Task values without
+     * building a DOM, from JSON as well as CBOR or MessagePack. Accepts either
+     * a bare array of tasks or an object with a "tasks" array (and an optional
+     * "long_poll" flag), all other members are skipped. Each task is validated
+     * on its own against the field descriptors of its type: a task with missing,
+     * unknown, mistyped or out of range fields is reported through get_errors()
+     * and left out, while the remaining tasks are still delivered.
+     */
+    class TaskListParser final : public nlohmann::json_sax<nlohmann::json> {
+        enum class ValueKind : kstd::u8 {
+            NONE,
+            BOOLEAN,
+            INTEGER,
+            INVALID
+        };
+
+        struct PendingValue final {
+            ValueKind kind;
+            kstd::i64 value;
+        };
+
+        std::vector<dto::Task> _tasks;
+        std::vector<TaskError> _errors;
+        std::string _parse_error;
+        kstd::usize _depth;
+        kstd::usize _tasks_depth;   // Depth of the tasks array, 0 while outside of it
+        kstd::usize _skip_depth;    // Depth of a container which is being skipped, 0 if none
+        kstd::usize _num_entries;
+        bool _is_tasks_key;
+        bool _is_long_poll_key;
+        bool _has_tasks;
+        bool _is_long_poll;
+        kstd::usize _slot;
+        std::array<PendingValue, TaskKeySet::SIZE> _values;
+
+        [[nodiscard]] inline auto is_skipping() const noexcept -> bool {
+            return _skip_depth != 0;
+        }
+
+        [[nodiscard]] inline auto is_in_task_list() const noexcept -> bool {
+            return _tasks_depth != 0 && _depth == _tasks_depth;
+        }
+
+        [[nodiscard]] inline auto is_in_task() const noexcept -> bool {
+            return _tasks_depth != 0 && _depth == _tasks_depth + 1;
+        }
+
+        inline auto set_value(ValueKind kind, kstd::i64 value = 0) noexcept -> void {
+            if (is_skipping()) {
+                return;
+            }
+
+            if (is_in_task_list()) {
+                _errors.push_back({_num_entries++, "task must be an object", {}});
+                return;
+            }
+
+            if (is_in_task() && _slot != TaskKeySet::NO_SLOT) {
+                _values[_slot] = {kind, value};
+            }
+        }
+
+        /**
+         * Enters a container which is of no interest and skips everything inside it.
+         */
+        inline auto skip_container() noexcept -> void {
+            set_value(ValueKind::INVALID);
+            ++_depth;
+
+            if (!is_skipping()) {
+                _skip_depth = _depth;
+            }
+        }
+
+        /**
+         * @return True if the container was skipped.
+         */
+        inline auto leave_skipped_container() noexcept -> bool {
+            if (!is_skipping()) {
+                return false;
+            }
+
+            if (_depth == _skip_depth) {
+                _skip_depth = 0;
+            }
+
+            --_depth;
+            return true;
+        }
+
+        template<typename T>
+        inline auto decode_task(kstd::usize index) noexcept -> void {
+            T task{};
+            const char* error = nullptr;
+            std::string_view error_field;
+
+            for_each_field<T>([&](const auto& field) {
+                using Member = typename std::remove_cvref_t<decltype(field)>::Member;
+
+                if (error != nullptr) {
+                    return;
+                }
+
+                const auto& value = _values[TaskKeySet::find_slot(field.name)];
+
+                if (value.kind == ValueKind::NONE) {
+                    error = "missing field";
+                }
+                else if (value.kind == ValueKind::INVALID || (value.kind == ValueKind::BOOLEAN) != std::is_same_v<Member, bool>) {
+                    error = "field has the wrong type";
+                }
+                else if (!assign_field(field, task, value.value)) {
+                    error = "field is out of range";
+                }
+
+                if (error != nullptr) {
+                    error_field = field.name;
+                }
+            });
+
+            if (error != nullptr) {
+                _errors.push_back({index, error, error_field});
+                return;
+            }
+
+            _tasks.emplace_back(task);
+        }
+
+        /**
+         * @return False if none of the task types has the given type.
+         */
+        template<typename... T>
+        inline auto decode_task(kstd::usize index, kstd::i64 type, [[maybe_unused]] const std::variant<T...>* tag) noexcept -> bool {
+            return ((static_cast<kstd::i64>(T::TYPE) == type ? (decode_task<T>(index), true) : false) || ...);
+        }
+
+        inline auto finish_task() noexcept -> void {
+            const auto index = _num_entries++;
+            const auto& type = _values[TaskKeySet::TYPE_SLOT];
+
+            if (type.kind == ValueKind::NONE) {
+                _errors.push_back({index, "missing field", "type"});
+                return;
+            }
+
+            if (type.kind != ValueKind::INTEGER) {
+                _errors.push_back({index, "field has the wrong type", "type"});
+                return;
+            }
+
+            if (!decode_task(index, type.value, static_cast<const dto::Task*>(nullptr))) {
+                _errors.push_back({index, "unknown task type", {}});
+            }
+        }
+
+        public:
+
+        TaskListParser() noexcept:
+                _tasks(),
+                _errors(),
+                _parse_error(),
+                _depth(0),
+                _tasks_depth(0),
+                _skip_depth(0),
+                _num_entries(0),
+                _is_tasks_key(false),
+                _is_long_poll_key(false),
+                _has_tasks(false),
+                _is_long_poll(false),
+                _slot(TaskKeySet::NO_SLOT),
+                _values() {
+        }
+
+        /**
+         * Parses the given document, replacing the results of the previous call
+         * while keeping the allocated capacity.
+         * @return False if the document is malformed.
+         */
+        auto parse(std::string_view document, WireFormat format = WireFormat::JSON) noexcept -> bool {
+            _tasks.clear();
+            _errors.clear();
+            _parse_error.clear();
+            _depth = 0;
+            _tasks_depth = 0;
+            _skip_depth = 0;
+            _num_entries = 0;
+            _is_tasks_key = false;
+            _is_long_poll_key = false;
+            _has_tasks = false;
+            _is_long_poll = false;
+            _slot = TaskKeySet::NO_SLOT;
+
+            try {
+                return nlohmann::json::sax_parse(document.begin(), document.end(), this, get_input_format(format));
+            }
+            catch (const std::exception& error) {
+                _parse_error = error.what();
+                return false;
+            }
+        }
+
+        auto null() -> bool override {
+            set_value(ValueKind::INVALID);
+            return true;
+        }
+
+        auto boolean(bool value) -> bool override {
+            if (!is_skipping() && _depth == 1 && _tasks_depth == 0 && _is_long_poll_key) {
+                _is_long_poll = value;
+                return true;
+            }
+
+            set_value(ValueKind::BOOLEAN, value ? 1 : 0);
+            return true;
+        }
+
+        auto number_integer(number_integer_t value) -> bool override {
+            set_value(ValueKind::INTEGER, value);
+            return true;
+        }
+
+        auto number_unsigned(number_unsigned_t value) -> bool override {
+            // Values beyond the signed range are out of range for every field anyway
+            set_value(ValueKind::INTEGER, value > static_cast<number_unsigned_t>(std::numeric_limits<kstd::i64>::max()) ? std::numeric_limits<kstd::i64>::max() : static_cast<kstd::i64>(value));
+            return true;
+        }
+
+        auto number_float([[maybe_unused]] number_float_t value, [[maybe_unused]] const string_t& text) -> bool override {
+            set_value(ValueKind::INVALID);
+            return true;
+        }
+
+        auto string([[maybe_unused]] string_t& value) -> bool override {
+            set_value(ValueKind::INVALID);
+            return true;
+        }
+
+        auto binary([[maybe_unused]] binary_t& value) -> bool override {
+            set_value(ValueKind::INVALID);
+            return true;
+        }
+
+        auto start_object([[maybe_unused]] std::size_t size) -> bool override {
+            if (!is_skipping() && _depth == 0) {
+                ++_depth;
+                return true;
+            }
+
+            if (!is_skipping() && is_in_task_list()) {
+                _values.fill({ValueKind::NONE, 0});
+                _slot = TaskKeySet::NO_SLOT;
+                ++_depth;
+                return true;
+            }
+
+            skip_container();
+            return true;
+        }
+
+        auto key(string_t& name) -> bool override {
+            if (is_skipping()) {
+                return true;
+            }
+
+            if (_depth == 1 && _tasks_depth == 0) {
+                _is_tasks_key = name == "tasks";
+                _is_long_poll_key = name == "long_poll";
+                return true;
+            }
+
+            if (is_in_task()) {
+                _slot = TaskKeySet::find_slot(name);
+            }
+
+            return true;
+        }
+
+        auto end_object() -> bool override {
+            if (leave_skipped_container()) {
+                return true;
+            }
+
+            if (is_in_task()) {
+                finish_task();
+            }
+
+            --_depth;
+            return true;
+        }
+
+        auto start_array([[maybe_unused]] std::size_t size) -> bool override {
+            // Either a bare task list or the tasks member of the response object
+            if (!is_skipping() && !_has_tasks && (_depth == 0 || (_depth == 1 && _is_tasks_key))) {
+                ++_depth;
+                _tasks_depth = _depth;
+                _has_tasks = true;
+                return true;
+            }
+
+            skip_container();
+            return true;
+        }
+
+        auto end_array() -> bool override {
+            if (leave_skipped_container()) {
+                return true;
+            }
+
+            if (is_in_task_list()) {
+                _tasks_depth = 0;
+            }
+
+            --_depth;
+            return true;
+        }
+
+        auto parse_error([[maybe_unused]] std::size_t position, [[maybe_unused]] const std::string& token, const nlohmann::detail::exception& error) -> bool override {
+            _parse_error = error.what();
+            return false;
+        }
+
+        [[nodiscard]] inline auto get_tasks() const noexcept -> const std::vector<dto::Task>& {
+            return _tasks;
+        }
+
+        [[nodiscard]] inline auto get_errors() const noexcept -> const std::vector<TaskError>& {
+            return _errors;
+        }
+
+        [[nodiscard]] inline auto get_parse_error() const noexcept -> const std::string& {
+            return _parse_error;
+        }
+
+        /**
+         * @return True if the document contained a task list at all.
+         */
+        [[nodiscard]] inline auto has_tasks() const noexcept -> bool {
+            return _has_tasks;
+        }
+
+        [[nodiscard]] inline auto is_long_poll() const noexcept -> bool {
+            return _is_long_poll;
+        }
+    };
+}
@@ -0,0 +1,112 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <span>
+#include <variant>
+#include <vector>
+#include <kstd/types.hpp>
+#include "dto.hpp"
+
+namespace fox {
+    /**
+     * The part of the device state which tasks can change.
+     */
+    struct TaskState final {
+        bool is_on;
+        kstd::i32 speed;
+        dto::Mode mode;
+
+        /**
+         * Applies a task the same way Server::set_is_on, set_speed and set_mode do.
+         */
+        constexpr auto apply(const dto::Task& task) noexcept -> void {
+            switch (dto::get_task_type(task)) {
+                case dto::TaskType::POWER: {
+                    const auto is_on_value = std::get<dto::PowerTask>(task).is_on;
+
+                    if (is_on != is_on_value) {
+                        is_on = is_on_value;
+                        speed = is_on ? 1 : 0;
+                    }
+                    break;
+                }
+                case dto::TaskType::SPEED: {
+                    const auto speed_value = std::get<dto::SpeedTask>(task).speed;
+
+                    if (!is_on && speed_value > 0) {
+                        is_on = true;
+                    }
+                    else if (is_on && speed_value == 0) {
+                        is_on = false;
+                    }
+
+                    speed = speed_value;
+                    break;
+                }
+                case dto::TaskType::MODE:
+                    if (is_on) {
+                        mode = std::get<dto::ModeTask>(task).mode;
+                    }
+                    break;
+            }
+        }
+    };
+
+    /**
+     * Collapses a batch of tasks into the smallest list which takes the device
+     * from the initial state to the same final state, so superseded speed
+     * changes or power toggles are never sent over the wire.
+     * @param reduced Receives the reduced tasks, cleared before.
+     */
+    constexpr auto reduce_tasks(const TaskState& initial, std::span<const dto::Task> tasks, std::vector<dto::Task>& reduced) noexcept -> void {
+        reduced.clear();
+
+        auto target = initial;
+
+        for (const auto& task: tasks) {
+            target.apply(task);
+        }
+
+        const auto push_power = [&reduced](bool is_on) {
+            reduced.emplace_back(dto::PowerTask{is_on});
+        };
+        const auto push_speed = [&reduced](kstd::i32 speed) {
+            reduced.emplace_back(dto::SpeedTask{speed});
+        };
+        const auto push_mode = [&reduced](dto::Mode mode) {
+            reduced.emplace_back(dto::ModeTask{mode});
+        };
+
+        const auto is_mode_changed = target.mode != initial.mode;
+
+        if (target.is_on) {
+            // A speed task turns the device on by itself
+            if (!initial.is_on || target.speed != initial.speed) {
+                push_speed(target.speed);
+            }
+
+            if (is_mode_changed) {
+                push_mode(target.mode);
+            }
+
+            return;
+        }
+
+        // The mode can only be changed while the device is on
+        if (is_mode_changed && !initial.is_on) {
+            push_power(true);
+        }
+
+        if (is_mode_changed) {
+            push_mode(target.mode);
+        }
+
+        if (initial.is_on || is_mode_changed) {
+            push_power(false);
+        }
+    }
+}
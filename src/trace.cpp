@@ -0,0 +1,216 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <iterator>
+#include <fmt/format.h>
+#include "trace.hpp"
+#include "json_writer.hpp"
+
+namespace fox {
+    constexpr kstd::u64 TRACE_RING_MASK = TRACE_RING_CAPACITY - 1;
+    constexpr kstd::u32 ACTIVE_TRACE_MASK = MAX_ACTIVE_TRACES - 1;
+
+    static_assert((TRACE_RING_CAPACITY & TRACE_RING_MASK) == 0 && (MAX_ACTIVE_TRACES & ACTIVE_TRACE_MASK) == 0);
+
+    [[nodiscard]] static constexpr auto pack_command(const Command& command) noexcept -> kstd::u64 {
+        return (static_cast<kstd::u64>(command.type) << 32) | static_cast<kstd::u32>(command.value);
+    }
+
+    [[nodiscard]] static constexpr auto unpack_command(kstd::u64 command) noexcept -> Command {
+        return {static_cast<CommandType>(command >> 32), static_cast<kstd::i32>(static_cast<kstd::u32>(command))};
+    }
+
+    [[nodiscard]] static constexpr auto get_command_type_name(CommandType type) noexcept -> const char* {
+        switch (type) {
+            case CommandType::POWER:
+                return "POWER";
+            case CommandType::SPEED:
+                return "SPEED";
+            default:
+                return "MODE";
+        }
+    }
+
+    auto LatencyHistogram::get_percentile(kstd::f64 fraction) const noexcept -> std::chrono::microseconds {
+        static_assert(get_bucket_index(31) == 31 && get_bucket_index(32) == 32 && get_bucket_index(34) == 33);
+        static_assert(get_bucket_limit(get_bucket_index(1000)) >= 1000 && get_bucket_index(get_bucket_limit(get_bucket_index(1000))) == get_bucket_index(1000));
+        static_assert(get_bucket_index(~kstd::u64(0)) == NUM_BUCKETS - 1);
+
+        const auto total = get_count();
+
+        if (total == 0) {
+            return std::chrono::microseconds::zero();
+        }
+
+        const auto rank = static_cast<kstd::u64>(fraction * static_cast<kstd::f64>(total - 1));
+        kstd::u64 seen = 0;
+
+        for (kstd::usize index = 0; index < NUM_BUCKETS; ++index) {
+            seen += _counts[index].load(std::memory_order_relaxed);
+
+            if (seen > rank) {
+                // Never report more than was actually seen, the last bucket is usually wider than that
+                return std::min(std::chrono::microseconds(get_bucket_limit(index)), get_max());
+            }
+        }
+
+        return get_max();
+    }
+
+    CommandTracer::CommandTracer() noexcept:
+            _events(),
+            _head(0),
+            _next_id(NO_TRACE + 1),
+            _active(),
+            _latencies() {
+    }
+
+    auto CommandTracer::append(kstd::u32 trace_id, TraceStage stage, kstd::u64 command, kstd::i64 timestamp) noexcept -> void {
+        const auto index = _head.fetch_add(1, std::memory_order_relaxed);
+        auto& slot = _events[index & TRACE_RING_MASK];
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.trace.store(trace_id | (static_cast<kstd::u64>(stage) << 32), std::memory_order_relaxed);
+        slot.command.store(command, std::memory_order_relaxed);
+        slot.timestamp.store(timestamp, std::memory_order_relaxed);
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    template<typename F>
+    auto CommandTracer::for_each_event(F&& function) const noexcept -> void {
+        const auto head = _head.load(std::memory_order_acquire);
+        const auto tail = head > TRACE_RING_CAPACITY ? head - TRACE_RING_CAPACITY : 0;
+
+        for (auto index = tail; index < head; ++index) {
+            const auto& slot = _events[index & TRACE_RING_MASK];
+
+            // Skip events which are being written or were overwritten while reading them
+            if (slot.sequence.load(std::memory_order_acquire) != 2 * index + 2) {
+                continue;
+            }
+
+            const auto trace = slot.trace.load(std::memory_order_relaxed);
+            const auto command = unpack_command(slot.command.load(std::memory_order_relaxed));
+            const auto timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) != 2 * index + 2) {
+                continue;
+            }
+
+            function(Event{static_cast<kstd::u32>(trace), static_cast<TraceStage>(trace >> 32), command.type, command.value, timestamp});
+        }
+    }
+
+    auto CommandTracer::begin(const Command& command, TraceClock::time_point received_at) noexcept -> kstd::u32 {
+        auto trace_id = _next_id.fetch_add(1, std::memory_order_relaxed);
+
+        if (trace_id == NO_TRACE) {
+            trace_id = _next_id.fetch_add(1, std::memory_order_relaxed); // Wrapped around
+        }
+
+        auto& active = _active[trace_id & ACTIVE_TRACE_MASK];
+        active.id.store(NO_TRACE, std::memory_order_relaxed);
+
+        for (auto& timestamp: active.timestamps) {
+            timestamp.store(0, std::memory_order_relaxed);
+        }
+
+        const auto packed = pack_command(command);
+        const auto received = received_at.time_since_epoch().count();
+        active.command.store(packed, std::memory_order_relaxed);
+        active.timestamps[static_cast<kstd::usize>(TraceStage::RECEIVED)].store(received, std::memory_order_relaxed);
+        active.id.store(trace_id, std::memory_order_release);
+
+        append(trace_id, TraceStage::RECEIVED, packed, received);
+        return trace_id;
+    }
+
+    auto CommandTracer::record(kstd::u32 trace_id, TraceStage stage) noexcept -> void {
+        if (trace_id == NO_TRACE) {
+            return;
+        }
+
+        auto& active = _active[trace_id & ACTIVE_TRACE_MASK];
+
+        if (active.id.load(std::memory_order_acquire) != trace_id) {
+            return; // Superseded by a newer trace
+        }
+
+        const auto index = static_cast<kstd::usize>(stage);
+        const auto now = TraceClock::now().time_since_epoch().count();
+        kstd::i64 expected = 0;
+
+        if (!active.timestamps[index].compare_exchange_strong(expected, now, std::memory_order_relaxed)) {
+            return;
+        }
+
+        append(trace_id, stage, active.command.load(std::memory_order_relaxed), now);
+
+        if (const auto previous = active.timestamps[index - 1].load(std::memory_order_relaxed); previous != 0) {
+            _latencies[index].record(TraceClock::duration(now - previous));
+        }
+
+        if (stage == TraceStage::ACKNOWLEDGED) {
+            const auto received = active.timestamps[static_cast<kstd::usize>(TraceStage::RECEIVED)].load(std::memory_order_relaxed);
+            _latencies[0].record(TraceClock::duration(now - received));
+        }
+    }
+
+    auto CommandTracer::write_chrome_trace(std::string& buffer) const noexcept -> void {
+        JsonWriter writer(buffer);
+        std::array<char, 32> name{};
+
+        writer.begin_object();
+        writer.key("traceEvents");
+        writer.begin_array();
+
+        for_each_event([&writer, &name](const Event& event) {
+            const auto* const end = fmt::format_to_n(name.data(), name.size(), "{} {}", get_command_type_name(event.type), event.value).out;
+            const char* phase = "n";
+
+            if (event.stage == TraceStage::RECEIVED) {
+                phase = "b";
+            }
+            else if (event.stage == TraceStage::ACKNOWLEDGED) {
+                phase = "e";
+            }
+
+            writer.begin_object();
+            writer.field("name", std::string_view(name.data(), static_cast<kstd::usize>(end - name.data())));
+            writer.field("cat", "command");
+            writer.field("ph", phase);
+            writer.field("id", event.trace_id);
+            writer.field("ts", event.timestamp / 1000); // Microseconds
+            writer.field("pid", 1);
+            writer.field("tid", static_cast<kstd::u32>(event.stage));
+            writer.key("args");
+            writer.begin_object();
+            writer.field("stage", get_trace_stage_name(event.stage));
+            writer.end_object();
+            writer.end_object();
+        });
+
+        writer.end_array();
+        writer.field("displayTimeUnit", "ms");
+        writer.end_object();
+    }
+
+    auto CommandTracer::write_latency_report(std::string& buffer) const noexcept -> void {
+        auto output = std::back_inserter(buffer);
+        fmt::format_to(output, "{:<26}{:>8}{:>10}{:>10}{:>10}{:>10}{:>10}\n", "Latency (us)", "count", "p50", "p90", "p99", "p99.9", "max");
+
+        for (kstd::usize index = 0; index < _latencies.size(); ++index) {
+            const auto& latency = _latencies[index];
+            const auto label = index == 0
+                ? std::string("received -> acknowledged")
+                : fmt::format("{} -> {}", get_trace_stage_name(static_cast<TraceStage>(index - 1)), get_trace_stage_name(static_cast<TraceStage>(index)));
+
+            fmt::format_to(output, "{:<26}{:>8}{:>10}{:>10}{:>10}{:>10}{:>10}\n", label, latency.get_count(), latency.get_percentile(0.5).count(),
+                latency.get_percentile(0.9).count(), latency.get_percentile(0.99).count(), latency.get_percentile(0.999).count(), latency.get_max().count());
+        }
+    }
+}
@@ -0,0 +1,198 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <string>
+#include <kstd/types.hpp>
+#include "protocol.hpp"
+
+namespace fox {
+    constexpr kstd::usize TRACE_RING_CAPACITY = 4096;
+    constexpr kstd::usize MAX_ACTIVE_TRACES = 256; // Traces older than this can't be correlated anymore
+    constexpr kstd::u32 NO_TRACE = 0;
+
+    using TraceClock = std::chrono::steady_clock;
+
+    enum class TraceStage : kstd::u8 {
+        RECEIVED,     // The task arrived from the gateway or the local endpoint
+        APPLIED,      // The task survived the reduction and its command is posted to the TX queue
+        SENT,         // The first message for the command was planned and queued for the serial device
+        ACKNOWLEDGED, // The device acknowledged the first message
+        NUM_STAGES
+    };
+
+    [[nodiscard]] constexpr auto get_trace_stage_name(TraceStage stage) noexcept -> const char* {
+        switch (stage) {
+            case TraceStage::RECEIVED:
+                return "received";
+            case TraceStage::APPLIED:
+                return "applied";
+            case TraceStage::SENT:
+                return "sent";
+            default:
+                return "acknowledged";
+        }
+    }
+
+    /**
+     * Log-linear latency histogram in the spirit of HdrHistogram. Values are
+     * recorded in microseconds, with 16 linear sub-buckets per power of two,
+     * so every recorded value is resolved to within ~6% over the whole range.
+     */
+    class LatencyHistogram final {
+        static constexpr kstd::u32 SUB_BUCKET_BITS = 4;
+        static constexpr kstd::u64 SUB_BUCKET_COUNT = 1U << SUB_BUCKET_BITS;
+        static constexpr kstd::usize NUM_BUCKETS = 2 * SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKET_COUNT;
+
+        std::array<std::atomic_uint64_t, NUM_BUCKETS> _counts;
+        std::atomic_uint64_t _total;
+        std::atomic_uint64_t _max;
+
+        [[nodiscard]] static constexpr auto get_bucket_index(kstd::u64 value) noexcept -> kstd::usize {
+            if (value < 2 * SUB_BUCKET_COUNT) {
+                return static_cast<kstd::usize>(value);
+            }
+
+            // Keep the top SUB_BUCKET_BITS + 1 bits of the value
+            const auto shift = static_cast<kstd::u32>(std::bit_width(value)) - SUB_BUCKET_BITS - 1;
+            const auto mantissa = value >> shift; // In [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT)
+            return static_cast<kstd::usize>(2 * SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_COUNT + (mantissa - SUB_BUCKET_COUNT));
+        }
+
+        /**
+         * @return The largest value which falls into the given bucket.
+         */
+        [[nodiscard]] static constexpr auto get_bucket_limit(kstd::usize index) noexcept -> kstd::u64 {
+            if (index < 2 * SUB_BUCKET_COUNT) {
+                return index;
+            }
+
+            const auto offset = index - 2 * SUB_BUCKET_COUNT;
+            const auto shift = static_cast<kstd::u32>(offset / SUB_BUCKET_COUNT) + 1;
+            const auto mantissa = SUB_BUCKET_COUNT + offset % SUB_BUCKET_COUNT;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+        public:
+
+        LatencyHistogram() noexcept:
+                _counts(),
+                _total(0),
+                _max(0) {
+        }
+
+        inline auto record(std::chrono::nanoseconds duration) noexcept -> void {
+            const auto value = static_cast<kstd::u64>(std::max<kstd::i64>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), 0));
+            _counts[get_bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+            _total.fetch_add(1, std::memory_order_relaxed);
+
+            auto max = _max.load(std::memory_order_relaxed);
+
+            while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+         * @return The value below which the given fraction of all samples lies, accurate to the bucket resolution.
+         */
+        [[nodiscard]] auto get_percentile(kstd::f64 fraction) const noexcept -> std::chrono::microseconds;
+
+        [[nodiscard]] inline auto get_count() const noexcept -> kstd::u64 {
+            return _total.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] inline auto get_max() const noexcept -> std::chrono::microseconds {
+            return std::chrono::microseconds(_max.load(std::memory_order_relaxed));
+        }
+    };
+
+    /**
+     * Follows commands from the task which caused them to the acknowledgement
+     * by the device. Every stage a traced command passes is appended to a
+     * fixed lock-free ring which keeps the most recent TRACE_RING_CAPACITY
+     * events, and the time between consecutive stages feeds a latency histogram.
+     *
+     * Commands merged by the reduction or the planner never reach the later
+     * stages, their trace simply ends early. Safe to use from any thread.
+     */
+    class CommandTracer final {
+        // Written like a seqlock: odd sequence while the event is being written
+        struct Slot final {
+            std::atomic_uint64_t sequence;
+            std::atomic_uint64_t trace; // Trace ID and stage
+            std::atomic_uint64_t command; // Command type and value
+            std::atomic_int64_t timestamp;
+        };
+
+        struct ActiveTrace final {
+            std::atomic_uint32_t id;
+            std::atomic_uint64_t command;
+            std::array<std::atomic_int64_t, static_cast<kstd::usize>(TraceStage::NUM_STAGES)> timestamps;
+        };
+
+        struct Event final {
+            kstd::u32 trace_id;
+            TraceStage stage;
+            CommandType type;
+            kstd::i32 value;
+            kstd::i64 timestamp;
+        };
+
+        std::array<Slot, TRACE_RING_CAPACITY> _events;
+        std::atomic_uint64_t _head;
+        std::atomic_uint32_t _next_id;
+        std::array<ActiveTrace, MAX_ACTIVE_TRACES> _active;
+        std::array<LatencyHistogram, static_cast<kstd::usize>(TraceStage::NUM_STAGES)> _latencies; // Indexed by the later stage, 0 is end to end
+
+        auto append(kstd::u32 trace_id, TraceStage stage, kstd::u64 command, kstd::i64 timestamp) noexcept -> void;
+
+        /**
+         * Copies the events which are still in the ring, oldest first.
+         */
+        template<typename F>
+        auto for_each_event(F&& function) const noexcept -> void;
+
+        public:
+
+        CommandTracer() noexcept;
+
+        CommandTracer(const CommandTracer& other) = delete;
+
+        CommandTracer(CommandTracer&& other) = delete;
+
+        ~CommandTracer() noexcept = default;
+
+        auto operator =(const CommandTracer& other) -> CommandTracer& = delete;
+
+        auto operator =(CommandTracer&& other) -> CommandTracer& = delete;
+
+        /**
+         * Starts a trace for a command caused by a task, recording it as received at the given time.
+         * @return The ID to pass along with the command.
+         */
+        auto begin(const Command& command, TraceClock::time_point received_at) noexcept -> kstd::u32;
+
+        /**
+         * Records that a traced command reached the given stage, only the first time per stage counts.
+         */
+        auto record(kstd::u32 trace_id, TraceStage stage) noexcept -> void;
+
+        /**
+         * Writes the events in the ring as Chrome trace event JSON, to be loaded
+         * into chrome://tracing or Perfetto. Each trace is an async slice.
+         */
+        auto write_chrome_trace(std::string& buffer) const noexcept -> void;
+
+        /**
+         * Appends a percentile table per stage transition.
+         */
+        auto write_latency_report(std::string& buffer) const noexcept -> void;
+    };
+}
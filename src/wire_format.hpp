@@ -0,0 +1,131 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include <kstd/types.hpp>
+
+namespace fox {
+    /**
+     * Encoding of the request and response bodies exchanged with the gateway.
+     * The binary formats carry the same documents as JSON, just more compact.
+     */
+    enum class WireFormat : kstd::u8 {
+        JSON,
+        CBOR,
+        MSGPACK
+    };
+
+    [[nodiscard]] constexpr auto parse_wire_format(std::string_view name) noexcept -> std::optional<WireFormat> {
+        if (name == "json") {
+            return WireFormat::JSON;
+        }
+
+        if (name == "cbor") {
+            return WireFormat::CBOR;
+        }
+
+        if (name == "msgpack") {
+            return WireFormat::MSGPACK;
+        }
+
+        return std::nullopt;
+    }
+
+    [[nodiscard]] constexpr auto get_wire_format_name(WireFormat format) noexcept -> const char* {
+        switch (format) {
+            case WireFormat::CBOR:
+                return "CBOR";
+            case WireFormat::MSGPACK:
+                return "MessagePack";
+            default:
+                return "JSON";
+        }
+    }
+
+    [[nodiscard]] constexpr auto get_mime_type(WireFormat format) noexcept -> const char* {
+        switch (format) {
+            case WireFormat::CBOR:
+                return "application/cbor";
+            case WireFormat::MSGPACK:
+                return "application/msgpack";
+            default:
+                return "application/json";
+        }
+    }
+
+    /**
+     * @return The Accept header value asking for the given format, with JSON as the fallback.
+     */
+    [[nodiscard]] constexpr auto get_accept_header(WireFormat format) noexcept -> const char* {
+        switch (format) {
+            case WireFormat::CBOR:
+                return "application/cbor, application/json;q=0.5";
+            case WireFormat::MSGPACK:
+                return "application/msgpack, application/x-msgpack;q=0.9, application/json;q=0.5";
+            default:
+                return "application/json";
+        }
+    }
+
+    /**
+     * @param content_type The value of a Content-Type header, parameters are ignored.
+     * @return The format of the body, JSON for unknown or missing types.
+     */
+    [[nodiscard]] constexpr auto get_wire_format_of(std::string_view content_type) noexcept -> WireFormat {
+        content_type = content_type.substr(0, content_type.find(';'));
+
+        while (!content_type.empty() && content_type.back() == ' ') {
+            content_type.remove_suffix(1);
+        }
+
+        if (content_type == "application/cbor") {
+            return WireFormat::CBOR;
+        }
+
+        if (content_type == "application/msgpack" || content_type == "application/x-msgpack") {
+            return WireFormat::MSGPACK;
+        }
+
+        return WireFormat::JSON;
+    }
+
+    /**
+     * @param accept The value of an Accept header.
+     * @return The format of the first listed media type, JSON for anything else.
+     */
+    [[nodiscard]] constexpr auto get_preferred_wire_format(std::string_view accept) noexcept -> WireFormat {
+        return get_wire_format_of(accept.substr(0, accept.find(',')));
+    }
+
+    [[nodiscard]] constexpr auto get_input_format(WireFormat format) noexcept -> nlohmann::json::input_format_t {
+        switch (format) {
+            case WireFormat::CBOR:
+                return nlohmann::json::input_format_t::cbor;
+            case WireFormat::MSGPACK:
+                return nlohmann::json::input_format_t::msgpack;
+            default:
+                return nlohmann::json::input_format_t::json;
+        }
+    }
+
+    /**
+     * Decodes a whole document into a DOM, for small and rarely received bodies.
+     * @return A discarded value if the body is malformed.
+     */
+    [[nodiscard]] inline auto decode_document(std::string_view body, WireFormat format) noexcept -> nlohmann::json {
+        switch (format) {
+            case WireFormat::CBOR:
+                return nlohmann::json::from_cbor(body.begin(), body.end(), true, false);
+            case WireFormat::MSGPACK:
+                return nlohmann::json::from_msgpack(body.begin(), body.end(), true, false);
+            default:
+                return nlohmann::json::parse(body, nullptr, false);
+        }
+    }
+}
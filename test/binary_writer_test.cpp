@@ -0,0 +1,79 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "binary_writer.hpp"
+
+namespace fox::test {
+    [[nodiscard]] static auto to_bytes(std::string_view data) noexcept -> std::vector<kstd::u8> {
+        return {data.begin(), data.end()};
+    }
+
+    // Keys are written in alphabetical order, so the encoding has to match nlohmann::json's byte for byte
+    template<typename W>
+    static auto write_sample(W& writer) noexcept -> void {
+        writer.begin_object();
+        writer.field("a_small", 23);
+        writer.field("b_byte", 200);
+        writer.field("c_short", 40000);
+        writer.field("d_long", kstd::u64(1) << 40);
+        writer.field("e_negative", -1000);
+        writer.field("f_flag", true);
+        writer.field("g_text", "a string which is longer than thirty-two characters");
+        writer.key("h_list").begin_array();
+
+        for (auto index = 0; index < 20; ++index) {
+            writer.value(index);
+        }
+
+        writer.end_array();
+        writer.key("i_empty").begin_object().end_object();
+        writer.end_object();
+    }
+
+    [[nodiscard]] static auto get_sample() noexcept -> nlohmann::json {
+        std::string buffer;
+        JsonWriter writer(buffer);
+        write_sample(writer);
+        return nlohmann::json::parse(buffer);
+    }
+
+    TEST(BinaryWriter, EncodesCbor) {
+        std::string buffer;
+        BinaryWriter writer(buffer, WireFormat::CBOR);
+        write_sample(writer);
+
+        ASSERT_EQ(to_bytes(writer.get_view()), nlohmann::json::to_cbor(get_sample()));
+    }
+
+    TEST(BinaryWriter, EncodesMsgPack) {
+        std::string buffer;
+        BinaryWriter writer(buffer, WireFormat::MSGPACK);
+        write_sample(writer);
+
+        ASSERT_EQ(to_bytes(writer.get_view()), nlohmann::json::to_msgpack(get_sample()));
+    }
+
+    TEST(BinaryWriter, GrowsContainerHeaders) {
+        std::string buffer;
+
+        for (const auto format: {WireFormat::CBOR, WireFormat::MSGPACK}) {
+            BinaryWriter writer(buffer, format);
+            writer.begin_array();
+
+            for (auto index = 0; index < 70000; ++index) {
+                writer.value(false);
+            }
+
+            writer.end_array();
+
+            const auto decoded = format == WireFormat::CBOR ? nlohmann::json::from_cbor(writer.get_view()) : nlohmann::json::from_msgpack(writer.get_view());
+            ASSERT_EQ(decoded.size(), 70000) << get_wire_format_name(format);
+        }
+    }
+}
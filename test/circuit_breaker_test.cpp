@@ -0,0 +1,100 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+#include "circuit_breaker.hpp"
+
+namespace fox::test {
+    constexpr std::chrono::milliseconds MIN_OPEN_TIME(20);
+    constexpr std::chrono::milliseconds MAX_OPEN_TIME(40);
+
+    TEST(ExponentialBackoff, GrowsUpToLimit) {
+        ExponentialBackoff backoff(std::chrono::milliseconds(10), std::chrono::milliseconds(50), 2.0F, 0.0F);
+
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(10));
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(20));
+        ASSERT_FALSE(backoff.is_at_limit());
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(40));
+        ASSERT_TRUE(backoff.is_at_limit());
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(50));
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(50));
+
+        backoff.reset();
+        ASSERT_EQ(backoff.next(), std::chrono::milliseconds(10));
+    }
+
+    TEST(ExponentialBackoff, SpreadsDelaysByJitter) {
+        ExponentialBackoff backoff(std::chrono::milliseconds(100), std::chrono::milliseconds(10000), 1.0F, 0.2F);
+        auto is_spread = false;
+
+        for (auto index = 0; index < 100; ++index) {
+            const auto delay = backoff.next();
+            ASSERT_GE(delay, std::chrono::milliseconds(100));
+            ASSERT_LE(delay, std::chrono::milliseconds(120));
+            is_spread |= delay != std::chrono::milliseconds(100);
+        }
+
+        ASSERT_TRUE(is_spread);
+    }
+
+    TEST(ExponentialBackoff, KeepsJitteredDelaysWithinBounds) {
+        ExponentialBackoff backoff(std::chrono::milliseconds(10), std::chrono::milliseconds(1000), 2.0F, 0.5F);
+
+        for (auto index = 0; index < 100; ++index) {
+            const auto delay = backoff.next();
+            ASSERT_GE(delay, std::chrono::milliseconds(10));
+            ASSERT_LE(delay, std::chrono::milliseconds(1000));
+        }
+    }
+
+    TEST(CircuitBreaker, OpensAfterConsecutiveFailures) {
+        CircuitBreaker breaker(3, MIN_OPEN_TIME, MAX_OPEN_TIME);
+
+        ASSERT_FALSE(breaker.on_failure());
+        ASSERT_FALSE(breaker.on_failure());
+        ASSERT_FALSE(breaker.on_success()); // Resets the count of consecutive failures
+        ASSERT_FALSE(breaker.on_failure());
+        ASSERT_FALSE(breaker.on_failure());
+        ASSERT_TRUE(breaker.on_failure());
+
+        ASSERT_FALSE(breaker.try_acquire());
+        ASSERT_GT(breaker.get_remaining_open_time(), std::chrono::milliseconds::zero());
+
+        const auto stats = breaker.get_stats();
+        ASSERT_EQ(stats.state, CircuitState::OPEN);
+        ASSERT_EQ(stats.num_trips, 1);
+        ASSERT_EQ(stats.num_rejected, 1);
+    }
+
+    TEST(CircuitBreaker, LetsSingleProbeThroughAfterOpenTime) {
+        CircuitBreaker breaker(1, MIN_OPEN_TIME, MAX_OPEN_TIME);
+        ASSERT_TRUE(breaker.on_failure());
+
+        std::this_thread::sleep_for(breaker.get_remaining_open_time());
+
+        ASSERT_TRUE(breaker.try_acquire());
+        ASSERT_EQ(breaker.get_stats().state, CircuitState::HALF_OPEN);
+        ASSERT_FALSE(breaker.try_acquire());
+
+        ASSERT_TRUE(breaker.on_success());
+        ASSERT_EQ(breaker.get_stats().state, CircuitState::CLOSED);
+        ASSERT_TRUE(breaker.try_acquire());
+    }
+
+    TEST(CircuitBreaker, ReopensWhenProbeFails) {
+        CircuitBreaker breaker(1, MIN_OPEN_TIME, MAX_OPEN_TIME);
+        ASSERT_TRUE(breaker.on_failure());
+
+        std::this_thread::sleep_for(breaker.get_remaining_open_time());
+        ASSERT_TRUE(breaker.try_acquire());
+
+        ASSERT_TRUE(breaker.on_failure());
+        ASSERT_EQ(breaker.get_stats().state, CircuitState::OPEN);
+        ASSERT_EQ(breaker.get_stats().num_trips, 2);
+        ASSERT_FALSE(breaker.try_acquire());
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include "server.hpp"
+
+namespace fox::test {
+    constexpr kstd::u32 NUM_BENCHMARK_PRODUCERS = 3; // Gateway, monitor and console
+    constexpr kstd::u32 NUM_COMMANDS_PER_PRODUCER = 100000;
+
+    /**
+     * The TX queue as it was before moving to atomic_queue: a std::queue
+     * behind a single mutex shared by every producer and the reactor.
+     */
+    class MutexCommandQueue final {
+        std::queue<QueuedCommand> _queue;
+        std::mutex _mutex;
+
+        public:
+
+        MutexCommandQueue() noexcept:
+                _queue(),
+                _mutex() {
+        }
+
+        inline auto try_push(const QueuedCommand& command) noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            _queue.push(command);
+            return true;
+        }
+
+        inline auto try_pop(QueuedCommand& command) noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+
+            if (_queue.empty()) {
+                return false;
+            }
+
+            command = _queue.front();
+            _queue.pop();
+            return true;
+        }
+    };
+
+    /**
+     * Pushes commands from several producer threads while the calling thread pops them, like the reactor does.
+     * @return The number of commands moved through the queue per second.
+     */
+    template<typename Q>
+    [[nodiscard]] static auto measure_throughput(Q& queue) noexcept -> kstd::f64 {
+        constexpr auto num_commands = static_cast<kstd::u64>(NUM_BENCHMARK_PRODUCERS) * NUM_COMMANDS_PER_PRODUCER;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+
+        for (kstd::u32 index = 0; index < NUM_BENCHMARK_PRODUCERS; ++index) {
+            producers.emplace_back([&queue] {
+                for (kstd::u32 value = 0; value < NUM_COMMANDS_PER_PRODUCER; ++value) {
+                    const QueuedCommand command{{CommandType::SPEED, static_cast<kstd::i32>(value)}, NO_TRACE};
+
+                    // The bounded queue is drained concurrently, so a full queue only needs a moment
+                    while (!queue.try_push(command)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        QueuedCommand command{};
+
+        // The reactor would sleep on an empty queue, yielding keeps the consumer from starving the producers
+        for (kstd::u64 num_popped = 0; num_popped < num_commands;) {
+            if (queue.try_pop(command)) {
+                ++num_popped;
+                continue;
+            }
+
+            std::this_thread::yield();
+        }
+
+        for (auto& producer: producers) {
+            producer.join();
+        }
+
+        const std::chrono::duration<kstd::f64> elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<kstd::f64>(num_commands) / elapsed.count();
+    }
+
+    TEST(CommandQueueBenchmark, ComparesWithMutexQueue) {
+        atomic_queue::AtomicQueue2<QueuedCommand, TX_QUEUE_CAPACITY> atomic_queue;
+        MutexCommandQueue mutex_queue;
+
+        const auto atomic_throughput = measure_throughput(atomic_queue);
+        const auto mutex_throughput = measure_throughput(mutex_queue);
+        QueuedCommand command{};
+
+        ASSERT_FALSE(atomic_queue.try_pop(command));
+        ASSERT_FALSE(mutex_queue.try_pop(command));
+        fmt::print("Command queue throughput with {} producers: atomic_queue {:.1f}M/s, mutex queue {:.1f}M/s\n", NUM_BENCHMARK_PRODUCERS,
+                   atomic_throughput / 1e6, mutex_throughput / 1e6);
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <thread>
+#include <memory>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <gtest/gtest.h>
+#include "connection.hpp"
+
+namespace fox::test {
+    constexpr std::string_view TLS_GREETING = "ok";
+
+    /**
+     * Client and server context for handshakes over a local socket pair,
+     * the server uses a throwaway self-signed certificate.
+     */
+    class TlsContexts final {
+        std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> _client;
+        std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> _server;
+
+        public:
+
+        explicit TlsContexts(int max_version) noexcept:
+                _client(SSL_CTX_new(TLS_client_method()), SSL_CTX_free),
+                _server(SSL_CTX_new(TLS_server_method()), SSL_CTX_free) {
+            std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(EVP_EC_gen("P-256"), EVP_PKEY_free);
+            std::unique_ptr<X509, decltype(&X509_free)> certificate(X509_new(), X509_free);
+
+            ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 1);
+            X509_gmtime_adj(X509_getm_notBefore(certificate.get()), 0);
+            X509_gmtime_adj(X509_getm_notAfter(certificate.get()), 3600);
+            X509_set_pubkey(certificate.get(), key.get());
+            auto* name = X509_get_subject_name(certificate.get());
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+            X509_set_issuer_name(certificate.get(), name);
+            X509_sign(certificate.get(), key.get(), EVP_sha256());
+
+            SSL_CTX_use_certificate(_server.get(), certificate.get());
+            SSL_CTX_use_PrivateKey(_server.get(), key.get());
+            SSL_CTX_set_max_proto_version(_client.get(), max_version);
+        }
+
+        [[nodiscard]] inline auto get_client() const noexcept -> SSL_CTX* {
+            return _client.get();
+        }
+
+        /**
+         * Runs a handshake, receives a greeting and shuts the connection down again from both sides.
+         * @return True if the client resumed a session.
+         */
+        [[nodiscard]] auto connect() const noexcept -> bool {
+            std::array<int, 2> handles{};
+
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, handles.data()) != 0) {
+                return false;
+            }
+
+            std::thread server([context = _server.get(), handle = handles[1]] {
+                auto* ssl = SSL_new(context);
+                SSL_set_fd(ssl, handle);
+                std::array<char, 16> buffer{};
+
+                // Waits for the close notify of the client, so neither side ever writes to a closed socket
+                if (SSL_accept(ssl) == 1 && SSL_write(ssl, TLS_GREETING.data(), static_cast<int>(TLS_GREETING.size())) > 0 && SSL_read(ssl, buffer.data(), buffer.size()) <= 0) {
+                    SSL_shutdown(ssl);
+                }
+
+                SSL_free(ssl);
+                ::close(handle);
+            });
+
+            auto* ssl = SSL_new(_client.get());
+            SSL_set_fd(ssl, handles[0]);
+            std::array<char, 16> buffer{};
+
+            // TLS 1.3 tickets arrive after the handshake, ahead of the greeting
+            auto is_resumed = false;
+
+            if (SSL_connect(ssl) == 1 && SSL_read(ssl, buffer.data(), buffer.size()) > 0) {
+                is_resumed = SSL_session_reused(ssl) == 1;
+                SSL_shutdown(ssl);
+                SSL_read(ssl, buffer.data(), buffer.size());
+            }
+
+            SSL_free(ssl);
+            ::close(handles[0]);
+            server.join();
+            return is_resumed;
+        }
+    };
+
+    TEST(TlsSessionCache, ResumesSessionWithTls13) {
+        const TlsContexts contexts(TLS1_3_VERSION);
+        TlsSessionCache sessions(contexts.get_client(), "test");
+
+        ASSERT_FALSE(contexts.connect());
+        ASSERT_TRUE(contexts.connect());
+        ASSERT_EQ(sessions.get_num_handshakes(), 2);
+        ASSERT_EQ(sessions.get_num_resumed_handshakes(), 1);
+        ASSERT_EQ(sessions.get_handshakes_per_minute(), 2);
+    }
+
+    TEST(TlsSessionCache, ResumesSessionWithTls12) {
+        const TlsContexts contexts(TLS1_2_VERSION);
+        TlsSessionCache sessions(contexts.get_client(), "test");
+
+        ASSERT_FALSE(contexts.connect());
+        ASSERT_TRUE(contexts.connect());
+        ASSERT_EQ(sessions.get_num_resumed_handshakes(), 1);
+    }
+
+    TEST(TlsSessionCache, StartsOverAfterDrop) {
+        const TlsContexts contexts(TLS1_3_VERSION);
+        TlsSessionCache sessions(contexts.get_client(), "test");
+
+        ASSERT_FALSE(contexts.connect());
+        sessions.drop();
+
+        ASSERT_FALSE(contexts.connect());
+        ASSERT_EQ(sessions.get_num_handshakes(), 2);
+        ASSERT_EQ(sessions.get_num_resumed_handshakes(), 0);
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include "event_stream.hpp"
+
+namespace fox::test {
+    constexpr kstd::u32 NUM_STREAM_EVENTS = 6;
+    constexpr kstd::u32 NUM_EVENTS_BEFORE_DROP = 3;
+    constexpr kstd::u32 MAX_STREAM_ATTEMPTS = 4;
+
+    /**
+     * Serves GET /events on a loopback port. Each event carries its index as
+     * id and data, and a stream resumes right after the Last-Event-ID sent by
+     * the client. The first stream is dropped in the middle of an event, like
+     * a gateway behind a proxy which closes idle connections.
+     */
+    class EventStreamServer final {
+        httplib::Server _server;
+        kstd::i32 _port;
+        std::thread _thread;
+        std::mutex _mutex;
+        std::vector<std::string> _last_event_ids;
+
+        public:
+
+        EventStreamServer() noexcept:
+                _server(),
+                _port(0),
+                _thread(),
+                _mutex(),
+                _last_event_ids() {
+            _server.Get("/events", [this](const httplib::Request& request, httplib::Response& response) {
+                const auto last_event_id = request.get_header_value("Last-Event-ID");
+                const auto is_first = [this, &last_event_id] {
+                    std::scoped_lock lock(_mutex);
+                    _last_event_ids.push_back(last_event_id);
+                    return _last_event_ids.size() == 1;
+                }();
+
+                auto next = last_event_id.empty() ? 0U : static_cast<kstd::u32>(std::stoul(last_event_id)) + 1;
+
+                response.set_chunked_content_provider("text/event-stream", [next, is_first]([[maybe_unused]] size_t offset, httplib::DataSink& sink) mutable {
+                    if (is_first && next == NUM_EVENTS_BEFORE_DROP) {
+                        // Half an event, then the connection goes away without the terminating chunk
+                        const auto partial = fmt::format("id: {0}\nevent: tasks\ndata: {0}", next);
+                        sink.write(partial.data(), partial.size());
+                        return false;
+                    }
+
+                    if (next == NUM_STREAM_EVENTS) {
+                        sink.done();
+                        return true;
+                    }
+
+                    const auto event = fmt::format(": keep-alive\n\nid: {0}\nevent: tasks\ndata: {0}\n\n", next++);
+                    return sink.write(event.data(), event.size());
+                });
+            });
+
+            _port = _server.bind_to_any_port("127.0.0.1");
+            _thread = std::thread([this] {
+                _server.listen_after_bind();
+            });
+            _server.wait_until_ready();
+        }
+
+        EventStreamServer(const EventStreamServer& other) = delete;
+
+        EventStreamServer(EventStreamServer&& other) = delete;
+
+        ~EventStreamServer() noexcept {
+            _server.stop();
+
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        auto operator =(const EventStreamServer& other) -> EventStreamServer& = delete;
+
+        auto operator =(EventStreamServer&& other) -> EventStreamServer& = delete;
+
+        [[nodiscard]] inline auto get_port() const noexcept -> kstd::i32 {
+            return _port;
+        }
+
+        /**
+         * @return The Last-Event-ID header of every stream request, in order.
+         */
+        [[nodiscard]] inline auto get_last_event_ids() noexcept -> std::vector<std::string> {
+            std::scoped_lock lock(_mutex);
+            return _last_event_ids;
+        }
+    };
+
+    TEST(EventStream, ResumesAfterDroppedConnection) {
+        EventStreamServer server;
+        ASSERT_GT(server.get_port(), 0);
+
+        httplib::Client client("127.0.0.1", server.get_port());
+        EventStreamParser parser;
+        std::vector<std::string> received;
+
+        // Reconnects the same way the gateway stream loop does
+        for (kstd::u32 attempt = 0; attempt < MAX_STREAM_ATTEMPTS && received.size() < NUM_STREAM_EVENTS; ++attempt) {
+            parser.reset();
+
+            httplib::Headers headers{{"Accept", "text/event-stream"}};
+
+            if (!parser.get_last_event_id().empty()) {
+                headers.emplace("Last-Event-ID", parser.get_last_event_id());
+            }
+
+            client.Get("/events", headers, [](const httplib::Response& response) {
+                return response.status == 200;
+            }, [&parser, &received](const char* data, size_t size) {
+                parser.feed(std::string_view(data, size), [&received](std::string_view event, std::string_view data) {
+                    if (event == "tasks") {
+                        received.emplace_back(data);
+                    }
+                });
+
+                return true;
+            });
+        }
+
+        const std::vector<std::string> expected{"0", "1", "2", "3", "4", "5"};
+        ASSERT_EQ(received, expected);
+        ASSERT_EQ(server.get_last_event_ids(), (std::vector<std::string>{"", "2"}));
+    }
+
+    TEST(EventStreamParser, DropsPartialEventOnReset) {
+        EventStreamParser parser;
+        std::vector<std::string> received;
+        const auto on_event = [&received]([[maybe_unused]] std::string_view event, std::string_view data) {
+            received.emplace_back(data);
+        };
+
+        parser.feed("id: 1\ndata: first\n\nid: 2\nda", on_event);
+        ASSERT_EQ(parser.get_last_event_id(), "1");
+
+        parser.reset();
+        parser.feed("data: second\n\n", on_event);
+
+        // The id of the dropped event must not leak into the next one
+        ASSERT_EQ(parser.get_last_event_id(), "1");
+        ASSERT_EQ(received, (std::vector<std::string>{"first", "second"}));
+    }
+
+    TEST(EventStreamParser, KeepsLastEventIdAcrossResets) {
+        EventStreamParser parser;
+        parser.feed("id: 7\nevent: tasks\ndata: []\n\n", []([[maybe_unused]] std::string_view event, [[maybe_unused]] std::string_view data) {});
+
+        parser.reset();
+
+        ASSERT_EQ(parser.get_last_event_id(), "7");
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include "flow_control.hpp"
+
+namespace fox::test {
+    // Matches the defaults of the command line options, which don't retransmit on timeouts
+    constexpr serial::FlowControlPolicy DEFAULT_FLOW_CONTROL{16, std::chrono::milliseconds(500), 0};
+
+    TEST(FlowControl, RetransmitsOnNackWithDefaultPolicy) {
+        serial::FlowControl flow_control(DEFAULT_FLOW_CONTROL);
+        const auto now = serial::Clock::now();
+        const auto key = serial::make_sequence_key(7);
+        flow_control.on_sent(key, "frame", now);
+
+        std::string resent;
+        ASSERT_TRUE(flow_control.retransmit(key, now, [&resent](std::string_view packet) { resent = packet; }));
+        ASSERT_EQ(resent, "frame");
+        ASSERT_EQ(flow_control.get_num_in_flight(), 1);
+    }
+
+    TEST(FlowControl, LimitsNackRetransmits) {
+        serial::FlowControl flow_control(DEFAULT_FLOW_CONTROL);
+        const auto now = serial::Clock::now();
+        const auto key = serial::make_sequence_key(7);
+        flow_control.on_sent(key, "frame", now);
+
+        kstd::u32 num_resent = 0;
+
+        while (flow_control.retransmit(key, now, [&num_resent](std::string_view) { ++num_resent; })) {
+        }
+
+        ASSERT_EQ(num_resent, serial::MAX_NACK_RETRANSMITS);
+    }
+
+    TEST(FlowControl, DropsExpiredMessagesWithoutRetransmits) {
+        serial::FlowControl flow_control(DEFAULT_FLOW_CONTROL);
+        const auto now = serial::Clock::now();
+        flow_control.on_sent(serial::make_feedback_key(Feedback::SPEED_UP), "h", now);
+
+        ASSERT_EQ(flow_control.collect_expired(now + DEFAULT_FLOW_CONTROL.ack_timeout, [](std::string_view) { FAIL(); }), 1);
+        ASSERT_EQ(flow_control.get_num_in_flight(), 0);
+    }
+
+    TEST(FlowControl, AcknowledgesOldestMessageWithKey) {
+        serial::FlowControl flow_control(DEFAULT_FLOW_CONTROL);
+        const auto now = serial::Clock::now();
+        const auto key = serial::make_feedback_key(Feedback::SPEED_UP);
+        flow_control.on_sent(key, "h", now);
+        flow_control.on_sent(key, "h", now + std::chrono::milliseconds(10));
+
+        const auto acknowledgement = flow_control.on_acknowledged(key, now + std::chrono::milliseconds(30));
+        ASSERT_TRUE(acknowledgement);
+        ASSERT_EQ(acknowledgement->round_trip_time, std::chrono::milliseconds(30));
+        ASSERT_EQ(flow_control.get_num_in_flight(), 1);
+        ASSERT_FALSE(flow_control.on_acknowledged(serial::make_feedback_key(Feedback::SPEED_DOWN), now));
+    }
+
+    TEST(FlowControl, AttributesAcknowledgementsToTheirOwnTrace) {
+        serial::FlowControl flow_control(DEFAULT_FLOW_CONTROL);
+        const auto now = serial::Clock::now();
+        const auto key = serial::make_feedback_key(Feedback::SPEED_UP);
+        flow_control.on_sent(key, "h", now, 1);
+        flow_control.on_sent(key, "h", now, 2);
+
+        // Feedback lines can't be told apart, they are answered in order
+        ASSERT_EQ(flow_control.on_acknowledged(key, now)->trace_id, 1);
+        ASSERT_EQ(flow_control.on_acknowledged(key, now)->trace_id, 2);
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "json_writer.hpp"
+#include "reflect.hpp"
+#include "dto.hpp"
+
+namespace fox::test {
+    constexpr kstd::u32 NUM_ENCODINGS = 50000;
+    constexpr std::string_view BENCHMARK_PASSWORD = "p\"ass\\word\n"; // Needs escaping, like any password may
+    constexpr kstd::u64 BENCHMARK_TIMESTAMP = 1792108800000;
+    constexpr dto::DeviceState BENCHMARK_STATE{true, true, 12, 11, dto::Mode::DEFAULT};
+
+    // The /setstate body as Gateway::broadcast_state writes it
+    static auto write_set_state(std::string& buffer) noexcept -> void {
+        JsonWriter writer(buffer);
+        writer.begin_object();
+        writer.field("password", BENCHMARK_PASSWORD);
+        writer.field("timestamp", BENCHMARK_TIMESTAMP);
+        writer.key("state");
+        write_object(writer, BENCHMARK_STATE);
+        writer.end_object();
+    }
+
+    // The same body the way it was built before JsonWriter
+    [[nodiscard]] static auto dump_set_state() -> std::string {
+        nlohmann::json body;
+        body["password"] = BENCHMARK_PASSWORD;
+        body["timestamp"] = BENCHMARK_TIMESTAMP;
+        body["state"] = {
+            {"accepts_commands", BENCHMARK_STATE.accepts_commands},
+            {"is_on", BENCHMARK_STATE.is_on},
+            {"target_speed", BENCHMARK_STATE.target_speed},
+            {"actual_speed", BENCHMARK_STATE.actual_speed},
+            {"mode", BENCHMARK_STATE.mode}
+        };
+        return body.dump();
+    }
+
+    /**
+     * @return The average time one call of the given function took.
+     */
+    template<typename F>
+    [[nodiscard]] static auto measure_per_call(F&& function) -> std::chrono::nanoseconds {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (kstd::u32 index = 0; index < NUM_ENCODINGS; ++index) {
+            function();
+        }
+
+        return (std::chrono::steady_clock::now() - start) / NUM_ENCODINGS;
+    }
+
+    TEST(JsonWriterBenchmark, ComparesWithNlohmann) {
+        std::string buffer;
+        std::string dumped;
+
+        const auto writer_time = measure_per_call([&buffer] {
+            write_set_state(buffer);
+        });
+        const auto nlohmann_time = measure_per_call([&dumped] {
+            dumped = dump_set_state();
+        });
+
+        ASSERT_EQ(nlohmann::json::parse(buffer), nlohmann::json::parse(dumped));
+        fmt::print("/setstate body encoding: JsonWriter {}ns/op, nlohmann::json {}ns/op\n", writer_time.count(), nlohmann_time.count());
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <chrono>
+#include <csignal>
+#include <unistd.h>
+#include <pthread.h>
+#include <gtest/gtest.h>
+#include "lifecycle.hpp"
+
+namespace fox::test {
+    TEST(BoundedThread, KeepsRunningThreadJoinable) {
+        Latch release;
+        BoundedThread thread;
+        thread.start([&release] {
+            release.wait();
+        });
+
+        // Still uses the latch after the timeout, so it must not have been detached
+        ASSERT_FALSE(thread.join_for(std::chrono::milliseconds(20)));
+        ASSERT_TRUE(thread.is_started());
+
+        release.set();
+        ASSERT_TRUE(thread.join_for(std::chrono::milliseconds(1000)));
+        ASSERT_FALSE(thread.is_started());
+    }
+
+    TEST(BoundedThread, JoinsUnstartedThread) {
+        BoundedThread thread;
+        ASSERT_TRUE(thread.join_for(std::chrono::milliseconds(0)));
+    }
+
+    TEST(Lifecycle, RequestsShutdownOnSignal) {
+        Lifecycle lifecycle;
+        ::kill(::getpid(), SIGTERM);
+
+        lifecycle.wait();
+        ASSERT_STREQ(lifecycle.get_reason(), "terminated");
+    }
+
+    TEST(Lifecycle, RestoresSignalMask) {
+        {
+            Lifecycle lifecycle;
+        }
+
+        sigset_t signals{};
+        ::pthread_sigmask(SIG_SETMASK, nullptr, &signals);
+        ASSERT_FALSE(::sigismember(&signals, SIGINT));
+        ASSERT_FALSE(::sigismember(&signals, SIGTERM));
+    }
+}
@@ -0,0 +1,293 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <fmt/format.h>
+#include <kstd/platform/platform.hpp>
+#include "mcu_simulator.hpp"
+#include "protocol.hpp"
+
+namespace fox::test {
+    McuSimulator::McuSimulator(const PhysicalDelays& delays, bool supports_binary):
+            _master_handle(::posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK)),
+            _slave_handle(-1),
+            _device_name(),
+            _delays(delays),
+            _supports_binary(supports_binary),
+            _is_binary(false),
+            _decoder(),
+            _mutex(),
+            _state_changed(),
+            _received(),
+            _last_received_at(),
+            _is_on(false),
+            _speed(0),
+            _is_commanded_on(false),
+            _commanded_speed(0),
+            _pending(),
+            _num_commands(0),
+            _lost_command(NO_LOST_COMMAND),
+            _is_running(true),
+            _thread() {
+        if (_master_handle == -1 || ::grantpt(_master_handle) != 0 || ::unlockpt(_master_handle) != 0) {
+            throw std::runtime_error(fmt::format("Could not open pseudo-terminal: {}", kstd::platform::get_last_error()));
+        }
+
+        std::array<char, 64> name{};
+
+        if (::ptsname_r(_master_handle, name.data(), name.size()) != 0) {
+            throw std::runtime_error(fmt::format("Could not resolve pseudo-terminal name: {}", kstd::platform::get_last_error()));
+        }
+
+        _device_name = name.data();
+        _slave_handle = ::open(_device_name.data(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+        if (_slave_handle == -1) {
+            throw std::runtime_error(fmt::format("Could not open pseudo-terminal slave: {}", kstd::platform::get_last_error()));
+        }
+
+        // Like the UART of the board, the line never echoes or translates anything
+        termios tty{};
+        ::tcgetattr(_slave_handle, &tty);
+        ::cfmakeraw(&tty);
+        ::tcsetattr(_slave_handle, TCSANOW, &tty);
+
+        _thread = std::thread(run_loop, this);
+    }
+
+    McuSimulator::~McuSimulator() noexcept {
+        _is_running = false;
+
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+
+        ::close(_slave_handle);
+        ::close(_master_handle);
+    }
+
+    auto McuSimulator::run_loop(McuSimulator* self) noexcept -> void {
+        std::array<char, SIMULATOR_BUFFER_SIZE> buffer{};
+        pollfd descriptor{self->_master_handle, POLLIN, 0};
+
+        while (self->_is_running) {
+            auto timeout = SIMULATOR_POLL_INTERVAL;
+
+            if (!self->_pending.empty()) {
+                const auto until_due = std::chrono::ceil<std::chrono::milliseconds>(self->_pending.front().due_at - SimulatorClock::now());
+                timeout = std::clamp(until_due, std::chrono::milliseconds::zero(), SIMULATOR_POLL_INTERVAL);
+            }
+
+            if (::poll(&descriptor, 1, static_cast<int>(timeout.count())) > 0 && (descriptor.revents & POLLIN) != 0) {
+                const auto result = ::read(self->_master_handle, buffer.data(), buffer.size());
+                const auto now = SimulatorClock::now();
+                const auto is_binary = self->_is_binary;
+
+                if (self->_supports_binary && result > 0) {
+                    self->_decoder.feed(std::span(reinterpret_cast<const kstd::u8*>(buffer.data()), static_cast<kstd::usize>(result)), [self, now](const DecodedFrame& frame) {
+                        handle_frame(self, frame, now);
+                    });
+                }
+
+                // The handshake contains no command characters, so the legacy parser may see it as well
+                for (auto index = 0; index < result && !is_binary; ++index) {
+                    handle_command(self, buffer[static_cast<kstd::usize>(index)], now);
+                }
+            }
+
+            emit_due_feedback(self, SimulatorClock::now());
+        }
+    }
+
+    auto McuSimulator::handle_command(McuSimulator* self, char command, SimulatorClock::time_point now) noexcept -> void {
+        if (self->_num_commands++ == self->_lost_command) {
+            return;
+        }
+
+        {
+            std::scoped_lock lock(self->_mutex);
+            self->_received.push_back(command);
+            self->_last_received_at = now;
+        }
+
+        self->_state_changed.notify_all();
+
+        switch (command) {
+            case MESSAGE_ON:
+                if (!self->_is_commanded_on) {
+                    self->_is_commanded_on = true;
+                    self->_commanded_speed = 1;
+                    schedule_feedback(self, "power_on", self->_delays.power, now);
+                }
+                break;
+            case MESSAGE_OFF:
+                if (self->_is_commanded_on) {
+                    self->_is_commanded_on = false;
+                    self->_commanded_speed = 0;
+                    schedule_feedback(self, "power_off", self->_delays.power, now);
+                }
+                break;
+            case MESSAGE_HIGHER:
+                if (self->_is_commanded_on) {
+                    ++self->_commanded_speed;
+                    schedule_feedback(self, "speed_up", self->_delays.step, now);
+                }
+                break;
+            case MESSAGE_LOWER:
+                if (self->_is_commanded_on && self->_commanded_speed > 1) {
+                    --self->_commanded_speed;
+                    schedule_feedback(self, "speed_down", self->_delays.step, now);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    auto McuSimulator::handle_frame(McuSimulator* self, const DecodedFrame& frame, SimulatorClock::time_point now) noexcept -> void {
+        if (frame.opcode == Opcode::HELLO) {
+            self->_is_binary = true;
+            write_frame(self, Opcode::HELLO_ACK, frame.sequence, std::array<kstd::u8, 1>{PROTOCOL_VERSION});
+            return;
+        }
+
+        if (!self->_is_binary) {
+            return;
+        }
+
+        switch (frame.opcode) {
+            case Opcode::POWER: {
+                const auto is_on = !frame.payload.empty() && frame.payload[0] != 0;
+
+                if (is_on != self->_is_commanded_on) {
+                    self->_is_commanded_on = is_on;
+                    self->_commanded_speed = is_on ? 1 : 0;
+                    schedule_feedback(self, is_on ? "power_on" : "power_off", self->_delays.power, now);
+                }
+                break;
+            }
+            case Opcode::SET_SPEED: {
+                const auto speed = frame.payload.size() >= sizeof(kstd::i32) ? read_le<kstd::i32>(frame.payload.data()) : 0;
+
+                if (speed <= 0) {
+                    if (self->_is_commanded_on) {
+                        self->_is_commanded_on = false;
+                        self->_commanded_speed = 0;
+                        schedule_feedback(self, "power_off", self->_delays.power, now);
+                    }
+                    break;
+                }
+
+                if (!self->_is_commanded_on) {
+                    self->_is_commanded_on = true;
+                    self->_commanded_speed = 1;
+                    schedule_feedback(self, "power_on", self->_delays.power, now);
+                }
+
+                // The firmware walks the motor through every step in between
+                for (; self->_commanded_speed < speed; ++self->_commanded_speed) {
+                    schedule_feedback(self, "speed_up", self->_delays.step, now);
+                }
+
+                for (; self->_commanded_speed > speed; --self->_commanded_speed) {
+                    schedule_feedback(self, "speed_down", self->_delays.step, now);
+                }
+                break;
+            }
+            default:
+                write_frame(self, Opcode::NACK, frame.sequence, {});
+                return;
+        }
+
+        // Acknowledged once the motor has carried out everything up to this command
+        const auto start = self->_pending.empty() ? now : std::max(now, self->_pending.back().due_at);
+        self->_pending.push_back({{}, start, frame.sequence});
+    }
+
+    auto McuSimulator::write_frame(McuSimulator* self, Opcode opcode, kstd::u8 sequence, std::span<const kstd::u8> payload) noexcept -> void {
+        const auto frame = encode_frame(opcode, sequence, payload);
+
+        if (::write(self->_master_handle, frame.data.data(), frame.size) != static_cast<ssize_t>(frame.size)) {
+            fmt::print(stderr, "Simulator could not write frame: {}\n", kstd::platform::get_last_error());
+        }
+    }
+
+    auto McuSimulator::schedule_feedback(McuSimulator* self, std::string_view token, std::chrono::milliseconds delay, SimulatorClock::time_point now) noexcept -> void {
+        // The motor executes one command at a time, so delays add up
+        const auto start = self->_pending.empty() ? now : std::max(now, self->_pending.back().due_at);
+        self->_pending.push_back({token, start + delay, std::nullopt});
+    }
+
+    auto McuSimulator::emit_due_feedback(McuSimulator* self, SimulatorClock::time_point now) noexcept -> void {
+        auto& pending = self->_pending;
+        auto is_changed = false;
+
+        while (!pending.empty() && pending.front().due_at <= now) {
+            const auto token = pending.front().token;
+            const auto sequence = pending.front().sequence;
+            pending.pop_front();
+
+            {
+                std::scoped_lock lock(self->_mutex);
+
+                switch (parse_feedback(token)) {
+                    case Feedback::POWER_ON:
+                        self->_is_on = true;
+                        self->_speed = 1;
+                        break;
+                    case Feedback::POWER_OFF:
+                        self->_is_on = false;
+                        self->_speed = 0;
+                        break;
+                    case Feedback::SPEED_UP:
+                        ++self->_speed;
+                        break;
+                    case Feedback::SPEED_DOWN:
+                        --self->_speed;
+                        break;
+                    case Feedback::UNKNOWN:
+                        break;
+                }
+            }
+
+            if (self->_is_binary) {
+                std::array<kstd::u8, 1 + sizeof(kstd::i32)> state{};
+
+                {
+                    std::scoped_lock lock(self->_mutex);
+                    state[0] = self->_is_on ? 1 : 0;
+                    write_le<kstd::i32>(state.data() + 1, self->_speed);
+                }
+
+                if (sequence) {
+                    write_frame(self, Opcode::ACK, *sequence, state);
+                }
+                else {
+                    write_frame(self, Opcode::STATE, 0, state);
+                }
+            }
+            else {
+                const auto line = fmt::format("{}\n", token);
+
+                if (::write(self->_master_handle, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+                    fmt::print(stderr, "Simulator could not write feedback: {}\n", kstd::platform::get_last_error());
+                }
+            }
+
+            is_changed = true;
+        }
+
+        if (is_changed) {
+            self->_state_changed.notify_all();
+        }
+    }
+}
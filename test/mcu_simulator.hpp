@@ -0,0 +1,161 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <span>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <condition_variable>
+#include <optional>
+#include <limits>
+#include <kstd/types.hpp>
+#include "protocol.hpp"
+
+namespace fox::test {
+    constexpr kstd::usize SIMULATOR_BUFFER_SIZE = 64;
+    constexpr std::chrono::milliseconds SIMULATOR_POLL_INTERVAL(10);
+    constexpr kstd::u32 NO_LOST_COMMAND = std::numeric_limits<kstd::u32>::max();
+
+    using SimulatorClock = std::chrono::steady_clock;
+
+    struct PhysicalDelays final {
+        std::chrono::milliseconds power; // Time the motor needs to start or stop
+        std::chrono::milliseconds step;  // Time the motor needs to change its speed by one step
+    };
+
+    /**
+     * Stands in for the microcontroller on the other end of the serial line.
+     * It opens a pseudo-terminal pair; the server opens the slave side by its
+     * device name, and the simulator speaks the legacy char protocol of the
+     * firmware on the master side. Commands are executed one after another
+     * like on the real motor, and each is answered with its feedback once its
+     * physical delay has passed. Commands the firmware ignores, like speed
+     * steps while powered off, are not answered at all.
+     *
+     * Newer firmware also answers the binary handshake. Once it received a
+     * HELLO frame it only speaks the binary protocol: every command frame is
+     * acknowledged after its physical delay with the resulting state, and
+     * each step on the way is reported with a STATE frame.
+     */
+    class McuSimulator final {
+        struct PendingFeedback final {
+            std::string_view token; // Empty if the physical state doesn't change
+            SimulatorClock::time_point due_at;
+            std::optional<kstd::u8> sequence; // Sequence of the command frame to acknowledge afterwards
+        };
+
+        kstd::i32 _master_handle;
+        kstd::i32 _slave_handle; // Held open, so the master never sees a hangup while the server isn't connected
+        std::string _device_name;
+        PhysicalDelays _delays;
+        bool _supports_binary;
+        bool _is_binary; // Only used on the simulator thread
+        FrameDecoder _decoder;
+        std::mutex _mutex;
+        std::condition_variable _state_changed;
+        std::string _received;
+        SimulatorClock::time_point _last_received_at; // When the last byte of _received was read from the line
+        bool _is_on;
+        kstd::i32 _speed;
+        bool _is_commanded_on; // The state the motor is heading to, only used on the simulator thread
+        kstd::i32 _commanded_speed;
+        std::deque<PendingFeedback> _pending;
+        kstd::u32 _num_commands; // Only used on the simulator thread
+        std::atomic<kstd::u32> _lost_command;
+        std::atomic_bool _is_running;
+        std::thread _thread;
+
+        static auto run_loop(McuSimulator* self) noexcept -> void;
+
+        static auto handle_command(McuSimulator* self, char command, SimulatorClock::time_point now) noexcept -> void;
+
+        static auto handle_frame(McuSimulator* self, const DecodedFrame& frame, SimulatorClock::time_point now) noexcept -> void;
+
+        static auto write_frame(McuSimulator* self, Opcode opcode, kstd::u8 sequence, std::span<const kstd::u8> payload) noexcept -> void;
+
+        static auto schedule_feedback(McuSimulator* self, std::string_view token, std::chrono::milliseconds delay, SimulatorClock::time_point now) noexcept -> void;
+
+        static auto emit_due_feedback(McuSimulator* self, SimulatorClock::time_point now) noexcept -> void;
+
+        public:
+
+        /**
+         * @param supports_binary True to simulate firmware which answers the binary handshake.
+         */
+        McuSimulator(const PhysicalDelays& delays, bool supports_binary);
+
+        McuSimulator(const McuSimulator& other) = delete;
+
+        McuSimulator(McuSimulator&& other) = delete;
+
+        ~McuSimulator() noexcept;
+
+        auto operator =(const McuSimulator& other) -> McuSimulator& = delete;
+
+        auto operator =(McuSimulator&& other) -> McuSimulator& = delete;
+
+        /**
+         * Blocks until the physical state of the motor satisfies the given predicate or the timeout ran out.
+         * @return False if the timeout ran out.
+         */
+        template<typename P>
+        inline auto wait_until(P&& predicate, std::chrono::milliseconds timeout) noexcept -> bool {
+            std::unique_lock lock(_mutex);
+            return _state_changed.wait_for(lock, timeout, [this, &predicate] {
+                return predicate(_is_on, _speed);
+            });
+        }
+
+        /**
+         * Loses the legacy command with the given index on the line, counted from the first
+         * byte received. The motor doesn't execute it, so its feedback line never arrives.
+         */
+        inline auto lose_command(kstd::u32 index) noexcept -> void {
+            _lost_command = index;
+        }
+
+        /**
+         * Blocks until the given number of bytes was received before the binary handshake or the timeout ran out.
+         * @return When the last of them was read from the line, or std::nullopt if the timeout ran out.
+         */
+        inline auto wait_for_received(kstd::usize count, std::chrono::milliseconds timeout) noexcept -> std::optional<SimulatorClock::time_point> {
+            std::unique_lock lock(_mutex);
+
+            if (!_state_changed.wait_for(lock, timeout, [this, count] { return _received.size() >= count; })) {
+                return std::nullopt;
+            }
+
+            return _last_received_at;
+        }
+
+        [[nodiscard]] inline auto get_device_name() const noexcept -> const std::string& {
+            return _device_name;
+        }
+
+        /**
+         * @return Every byte received before the binary handshake, in order.
+         */
+        [[nodiscard]] inline auto get_received() noexcept -> std::string {
+            std::scoped_lock lock(_mutex);
+            return _received;
+        }
+
+        [[nodiscard]] inline auto is_on() noexcept -> bool {
+            std::scoped_lock lock(_mutex);
+            return _is_on;
+        }
+
+        [[nodiscard]] inline auto get_speed() noexcept -> kstd::i32 {
+            std::scoped_lock lock(_mutex);
+            return _speed;
+        }
+    };
+}
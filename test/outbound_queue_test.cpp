@@ -0,0 +1,56 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include "outbound_queue.hpp"
+
+namespace fox::test {
+    constexpr std::chrono::milliseconds NO_WAIT(0);
+
+    TEST(OutboundQueue, RetriesFailedMessageBeforeLaterOnes) {
+        OutboundQueue<8> queue;
+        queue.push(Outbound::OFFLINE);
+        queue.push(Outbound::ONLINE);
+        queue.push(Outbound::SESSION);
+
+        // Sending OFFLINE fails twice, it must not be overtaken by ONLINE
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::OFFLINE);
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::OFFLINE);
+        queue.pop();
+
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::ONLINE);
+        queue.pop();
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::SESSION);
+        queue.pop();
+        ASSERT_EQ(queue.peek(NO_WAIT), std::nullopt);
+    }
+
+    TEST(OutboundQueue, CollapsesWaitingDuplicates) {
+        OutboundQueue<8> queue;
+        queue.push(Outbound::STATE);
+        queue.push(Outbound::STATE);
+        queue.push_unique(Outbound::ONLINE);
+        queue.push_unique(Outbound::ONLINE);
+
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::STATE);
+        queue.pop();
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::ONLINE);
+        queue.pop();
+        ASSERT_EQ(queue.peek(NO_WAIT), std::nullopt);
+    }
+
+    TEST(OutboundQueue, KeepsStateChangedWhileSending) {
+        OutboundQueue<8> queue;
+        queue.push(Outbound::STATE);
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::STATE);
+
+        // The snapshot being sent is already stale, so the new update has to be queued separately
+        queue.push(Outbound::STATE);
+        queue.pop();
+
+        ASSERT_EQ(queue.peek(NO_WAIT), Outbound::STATE);
+    }
+}
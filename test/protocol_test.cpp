@@ -0,0 +1,114 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "protocol.hpp"
+
+namespace fox::test {
+    [[nodiscard]] static auto as_bytes(const Frame& frame) noexcept -> std::span<const kstd::u8> {
+        return std::span(frame.data).first(frame.size);
+    }
+
+    TEST(Protocol, ComputesCrc8) {
+        constexpr std::string_view check = "123456789";
+        const std::vector<kstd::u8> data(check.begin(), check.end());
+
+        // Check value of CRC-8 with polynomial 0x07 and no reflection
+        ASSERT_EQ(crc8(data), 0xF4);
+        ASSERT_EQ(crc8({}), 0x00);
+    }
+
+    TEST(Protocol, DecodesEncodedFrame) {
+        const auto frame = encode_command({CommandType::SPEED, -3}, 42);
+        FrameDecoder decoder;
+        std::vector<DecodedFrame> frames;
+
+        // Split in the middle, like the kernel may do it
+        decoder.feed(as_bytes(frame).first(3), [&frames](const DecodedFrame& decoded) {
+            frames.push_back(decoded);
+        });
+        ASSERT_TRUE(frames.empty());
+
+        decoder.feed(as_bytes(frame).subspan(3), [&frames](const DecodedFrame& decoded) {
+            ASSERT_EQ(decoded.opcode, Opcode::SET_SPEED);
+            ASSERT_EQ(decoded.sequence, 42);
+            ASSERT_EQ(read_le<kstd::i32>(decoded.payload.data()), -3);
+            frames.push_back(decoded);
+        });
+
+        ASSERT_EQ(frames.size(), 1);
+        ASSERT_EQ(decoder.get_num_corrupted(), 0);
+    }
+
+    TEST(Protocol, DropsCorruptedFrameAndResynchronizes) {
+        auto corrupted = encode_command({CommandType::POWER, 1}, 1);
+        corrupted.data[FRAME_HEADER_SIZE] ^= 0x01;
+        const auto valid = encode_command({CommandType::POWER, 0}, 2);
+
+        std::vector<kstd::u8> stream{'x', 'y'};
+        stream.insert(stream.end(), as_bytes(corrupted).begin(), as_bytes(corrupted).end());
+        stream.insert(stream.end(), as_bytes(valid).begin(), as_bytes(valid).end());
+
+        FrameDecoder decoder;
+        std::vector<kstd::u8> sequences;
+        decoder.feed(stream, [&sequences](const DecodedFrame& decoded) {
+            sequences.push_back(decoded.sequence);
+        });
+
+        ASSERT_EQ(sequences, std::vector<kstd::u8>{2});
+        ASSERT_EQ(decoder.get_num_corrupted(), 1);
+    }
+
+    TEST(Protocol, KeepsFramesSwallowedByCorruptedLength) {
+        auto corrupted = encode_command({CommandType::POWER, 1}, 1);
+        corrupted.data[1] = MAX_PAYLOAD_SIZE - 1;
+        std::vector<kstd::u8> stream(as_bytes(corrupted).begin(), as_bytes(corrupted).end());
+
+        // The corrupted length covers the following frames, which are only rejected once it is complete
+        for (kstd::u8 sequence = 2; sequence <= 4; ++sequence) {
+            const auto valid = encode_command({CommandType::POWER, 0}, sequence);
+            stream.insert(stream.end(), as_bytes(valid).begin(), as_bytes(valid).end());
+        }
+
+        FrameDecoder decoder;
+        std::vector<kstd::u8> sequences;
+        decoder.feed(stream, [&sequences](const DecodedFrame& decoded) {
+            sequences.push_back(decoded.sequence);
+        });
+
+        ASSERT_EQ(sequences, (std::vector<kstd::u8>{2, 3, 4}));
+        ASSERT_EQ(decoder.get_num_corrupted(), 1);
+    }
+
+    TEST(Protocol, RejectsOversizedLength) {
+        const std::array<kstd::u8, 2> header{FRAME_SYNC, MAX_PAYLOAD_SIZE + 1};
+        FrameDecoder decoder;
+        auto num_frames = 0;
+
+        decoder.feed(header, [&num_frames]([[maybe_unused]] const DecodedFrame& decoded) {
+            ++num_frames;
+        });
+
+        ASSERT_EQ(num_frames, 0);
+        ASSERT_EQ(decoder.get_num_corrupted(), 1);
+    }
+
+    TEST(Protocol, EncodesHelloWithVersion) {
+        FrameDecoder decoder;
+        auto num_frames = 0;
+
+        decoder.feed(as_bytes(HELLO_FRAME), [&num_frames](const DecodedFrame& decoded) {
+            ASSERT_EQ(decoded.opcode, Opcode::HELLO);
+            ASSERT_EQ(decoded.payload.size(), 1);
+            ASSERT_EQ(decoded.payload[0], PROTOCOL_VERSION);
+            ++num_frames;
+        });
+
+        ASSERT_EQ(num_frames, 1);
+    }
+}
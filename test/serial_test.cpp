@@ -0,0 +1,26 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <gtest/gtest.h>
+#include "serial.hpp"
+
+namespace fox::test {
+    TEST(Serial, FallsBackToNearestBaudRate) {
+        ASSERT_EQ(serial::find_closest_baud_rate(250000), serial::BaudRate::_230400);
+        ASSERT_EQ(serial::find_closest_baud_rate(400000), serial::BaudRate::_460800);
+        ASSERT_EQ(serial::find_closest_baud_rate(110000), serial::BaudRate::_115200);
+    }
+
+    TEST(Serial, KeepsExactBaudRate) {
+        ASSERT_EQ(serial::find_closest_baud_rate(115200), serial::BaudRate::_115200);
+        ASSERT_EQ(serial::find_exact_baud_rate(921600), serial::BaudRate::_921600);
+        ASSERT_FALSE(serial::find_exact_baud_rate(250000).has_value());
+    }
+
+    TEST(Serial, ClampsToSupportedBaudRates) {
+        ASSERT_EQ(serial::find_closest_baud_rate(0), serial::BAUD_RATES[0]);
+        ASSERT_EQ(serial::find_closest_baud_rate(10000000), serial::BaudRate::_4000000);
+    }
+}
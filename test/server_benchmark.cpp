@@ -0,0 +1,82 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+#include "mcu_simulator.hpp"
+#include "lifecycle.hpp"
+#include "server.hpp"
+
+namespace fox::test {
+    constexpr PhysicalDelays BENCHMARK_DELAYS{std::chrono::milliseconds(2), std::chrono::milliseconds(1)};
+    constexpr serial::PacingPolicy BENCHMARK_PACING{std::chrono::microseconds(100), 16};
+    constexpr serial::FlowControlPolicy BENCHMARK_FLOW_CONTROL{16, std::chrono::milliseconds(500), 0};
+    constexpr kstd::u32 BENCHMARK_BAUD_RATE = 115200;
+    constexpr kstd::usize NUM_LATENCY_SAMPLES = 200;
+    constexpr std::chrono::milliseconds BENCHMARK_TIMEOUT(2000);
+
+    /**
+     * Blocks until the device reached the given speed and the server got every acknowledgement,
+     * so the next sample starts from an idle link.
+     * @return False if the timeout ran out.
+     */
+    static auto wait_until_idle(Server& server, kstd::i32 speed) noexcept -> bool {
+        const auto deadline = std::chrono::steady_clock::now() + BENCHMARK_TIMEOUT;
+        auto version = server.get_state_version();
+
+        while (server.get_actual_speed() != speed || server.get_num_in_flight() != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+
+            version = server.wait_for_state_change(version, std::chrono::milliseconds(50));
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] static auto get_percentile(const std::vector<std::chrono::microseconds>& sorted, kstd::f64 fraction) noexcept -> std::chrono::microseconds {
+        const auto index = static_cast<kstd::usize>(fraction * static_cast<kstd::f64>(sorted.size() - 1));
+        return sorted[index];
+    }
+
+    /**
+     * Measures the time from posting a command until its byte is read on the
+     * other end of the line, which covers the TX queue, the reactor wakeup,
+     * planning, pacing and the pseudo-terminal. Every sample is a single speed
+     * step taken from an idle link, the physical delays are kept short so the
+     * run stays quick.
+     */
+    TEST(ServerBenchmark, CommandToWireLatency) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(BENCHMARK_DELAYS, false);
+        Server server(lifecycle, simulator.get_device_name(), BENCHMARK_BAUD_RATE, BENCHMARK_PACING, BENCHMARK_FLOW_CONTROL, false, false);
+
+        server.set_speed(2);
+        ASSERT_TRUE(wait_until_idle(server, 2));
+
+        std::vector<std::chrono::microseconds> samples;
+        samples.reserve(NUM_LATENCY_SAMPLES);
+        auto num_received = simulator.get_received().size();
+
+        for (kstd::usize index = 0; index < NUM_LATENCY_SAMPLES; ++index) {
+            const auto speed = index % 2 == 0 ? 3 : 2;
+            const auto start = SimulatorClock::now();
+            server.set_speed(speed);
+
+            const auto received_at = simulator.wait_for_received(++num_received, BENCHMARK_TIMEOUT);
+            ASSERT_TRUE(received_at.has_value());
+            samples.push_back(std::chrono::duration_cast<std::chrono::microseconds>(*received_at - start));
+            ASSERT_TRUE(wait_until_idle(server, speed));
+        }
+
+        std::ranges::sort(samples);
+        fmt::print("Command to wire latency over {} samples: p50 {}us, p99 {}us, max {}us\n", samples.size(),
+                   get_percentile(samples, 0.5).count(), get_percentile(samples, 0.99).count(), samples.back().count());
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include "mcu_simulator.hpp"
+#include "lifecycle.hpp"
+#include "server.hpp"
+#include "dto.hpp"
+
+namespace fox::test {
+    constexpr PhysicalDelays TEST_DELAYS{std::chrono::milliseconds(20), std::chrono::milliseconds(5)};
+    constexpr serial::PacingPolicy TEST_PACING{std::chrono::microseconds(1000), 16};
+    constexpr serial::FlowControlPolicy TEST_FLOW_CONTROL{16, std::chrono::milliseconds(500), 0};
+    constexpr kstd::u32 TEST_BAUD_RATE = 115200;
+    constexpr bool TEST_NEGOTIATE_BINARY = false;
+    constexpr bool TEST_SUPPORTS_BINARY = false;
+    constexpr bool TEST_HAS_CONSOLE = false; // The test runner owns stdin
+    constexpr std::chrono::milliseconds WAIT_TIMEOUT(2000);
+    // Legacy firmware is only detected once every handshake attempt went unanswered
+    constexpr std::chrono::milliseconds NEGOTIATION_TIMEOUT = NEGOTIATION_INTERVAL * NEGOTIATION_ATTEMPTS + WAIT_TIMEOUT;
+
+    /**
+     * Blocks until the server saw the feedback for the given speed and nothing is in flight anymore.
+     * @return False if the timeout ran out.
+     */
+    static auto wait_for_actual_speed(Server& server, kstd::i32 speed, std::chrono::milliseconds timeout = WAIT_TIMEOUT) noexcept -> bool {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto version = server.get_state_version();
+
+        while (server.get_actual_speed() != speed || server.get_num_in_flight() != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+
+            version = server.wait_for_state_change(version, std::chrono::milliseconds(50));
+        }
+
+        return true;
+    }
+
+    TEST(Server, PowersOnAndStepsToTargetSpeed) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        server.set_speed(4);
+
+        ASSERT_TRUE(wait_for_actual_speed(server, 4));
+        ASSERT_TRUE(server.is_on());
+        ASSERT_EQ(simulator.get_speed(), 4);
+        ASSERT_EQ(simulator.get_received(), "ihhh");
+    }
+
+    TEST(Server, StepsDownWithoutPowerCycle) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        server.set_speed(3);
+        ASSERT_TRUE(wait_for_actual_speed(server, 3));
+        server.set_speed(2);
+
+        ASSERT_TRUE(wait_for_actual_speed(server, 2));
+        ASSERT_EQ(simulator.get_speed(), 2);
+        ASSERT_EQ(simulator.get_received(), "ihhl");
+    }
+
+    TEST(Server, AppliesNetChangeOfTaskBatch) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        const std::array<dto::Task, 4> tasks{dto::PowerTask{true}, dto::SpeedTask{6}, dto::SpeedTask{9}, dto::SpeedTask{3}};
+        server.apply_tasks(tasks);
+
+        ASSERT_TRUE(wait_for_actual_speed(server, 3));
+        ASSERT_EQ(simulator.get_received(), "ihh");
+    }
+
+    TEST(Server, TracesTasksUntilAcknowledged) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        const std::array<dto::Task, 1> tasks{dto::SpeedTask{2}};
+        server.apply_tasks(tasks);
+        ASSERT_TRUE(wait_for_actual_speed(server, 2));
+
+        std::string trace;
+        server.get_tracer().write_chrome_trace(trace);
+
+        ASSERT_NE(trace.find(R"("stage":"sent")"), std::string::npos);
+        ASSERT_NE(trace.find(R"("stage":"acknowledged")"), std::string::npos);
+    }
+
+    TEST(Server, ReplansAfterLostCommand) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        simulator.lose_command(2);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        server.set_speed(4);
+
+        // The missing feedback line is only noticed once the acknowledgement timed out
+        ASSERT_TRUE(wait_for_actual_speed(server, 4, TEST_FLOW_CONTROL.ack_timeout + WAIT_TIMEOUT));
+        ASSERT_EQ(simulator.get_speed(), 4);
+        ASSERT_EQ(simulator.get_received(), "ihhh");
+    }
+
+    TEST(Server, DrainsCommandsOnShutdown) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        server.set_speed(5);
+        ASSERT_TRUE(wait_for_actual_speed(server, 5));
+
+        ASSERT_TRUE(server.shutdown(WAIT_TIMEOUT));
+        ASSERT_FALSE(simulator.is_on());
+        ASSERT_EQ(simulator.get_received().back(), MESSAGE_OFF);
+    }
+
+    TEST(Server, RequestsShutdownWhenDeviceIsLost) {
+        Lifecycle lifecycle;
+        auto simulator = std::make_unique<McuSimulator>(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator->get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, TEST_NEGOTIATE_BINARY, TEST_HAS_CONSOLE);
+
+        server.set_speed(2);
+        ASSERT_TRUE(wait_for_actual_speed(server, 2));
+        simulator.reset();
+
+        const auto deadline = std::chrono::steady_clock::now() + WAIT_TIMEOUT;
+        auto version = server.get_state_version();
+
+        while (server.is_connected() && std::chrono::steady_clock::now() < deadline) {
+            version = server.wait_for_state_change(version, std::chrono::milliseconds(50));
+        }
+
+        ASSERT_FALSE(server.is_connected());
+        ASSERT_TRUE(lifecycle.is_shutdown_requested());
+
+        // Gives up right away instead of waiting out the drain timeout
+        const auto start = std::chrono::steady_clock::now();
+        ASSERT_FALSE(server.shutdown(WAIT_TIMEOUT));
+        ASSERT_LT(std::chrono::steady_clock::now() - start, WAIT_TIMEOUT / 2);
+    }
+
+    TEST(Server, NegotiatesBinaryProtocol) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, true);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, true, TEST_HAS_CONSOLE);
+
+        server.set_speed(4);
+        ASSERT_TRUE(wait_for_actual_speed(server, 4));
+        server.set_speed(2);
+
+        ASSERT_TRUE(wait_for_actual_speed(server, 2));
+        ASSERT_EQ(server.get_protocol(), Protocol::BINARY);
+        ASSERT_EQ(simulator.get_speed(), 2);
+    }
+
+    TEST(Server, FallsBackToLegacyProtocol) {
+        Lifecycle lifecycle;
+        McuSimulator simulator(TEST_DELAYS, TEST_SUPPORTS_BINARY);
+        Server server(lifecycle, simulator.get_device_name(), TEST_BAUD_RATE, TEST_PACING, TEST_FLOW_CONTROL, true, TEST_HAS_CONSOLE);
+
+        server.set_speed(3);
+
+        ASSERT_TRUE(wait_for_actual_speed(server, 3, NEGOTIATION_TIMEOUT));
+        ASSERT_EQ(server.get_protocol(), Protocol::LEGACY);
+        ASSERT_TRUE(simulator.get_received().ends_with("ihh"));
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @author F0x0
+ * @since 16/10/2026
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include "task_parser.hpp"
+#include "task_reducer.hpp"
+#include "binary_writer.hpp"
+
+namespace fox::test {
+    constexpr TaskState OFF_STATE{false, 0, dto::Mode::DEFAULT};
+
+    [[nodiscard]] static auto get_speed(const dto::Task& task) noexcept -> kstd::i32 {
+        const auto* speed_task = std::get_if<dto::SpeedTask>(&task);
+        return speed_task == nullptr ? -1 : speed_task->speed;
+    }
+
+    TEST(TaskListParser, ParsesBareTaskList) {
+        TaskListParser parser;
+
+        ASSERT_TRUE(parser.parse(R"([{"type": 0, "is_on": true}, {"speed": 3, "type": 1}])"));
+        ASSERT_TRUE(parser.has_tasks());
+        ASSERT_FALSE(parser.is_long_poll());
+        ASSERT_TRUE(parser.get_errors().empty());
+        ASSERT_EQ(parser.get_tasks().size(), 2);
+        ASSERT_TRUE(std::get<dto::PowerTask>(parser.get_tasks()[0]).is_on);
+        ASSERT_EQ(get_speed(parser.get_tasks()[1]), 3);
+    }
+
+    TEST(TaskListParser, ParsesResponseObject) {
+        TaskListParser parser;
+
+        ASSERT_TRUE(parser.parse(R"({"skipped": {"tasks": [1]}, "tasks": [{"type": 1, "speed": 5, "note": [null]}], "long_poll": true})"));
+        ASSERT_TRUE(parser.has_tasks());
+        ASSERT_TRUE(parser.is_long_poll());
+        ASSERT_EQ(parser.get_tasks().size(), 1);
+        ASSERT_EQ(get_speed(parser.get_tasks()[0]), 5);
+    }
+
+    TEST(TaskListParser, ReportsInvalidTasksAndKeepsTheRest) {
+        TaskListParser parser;
+
+        ASSERT_TRUE(parser.parse(R"([{"type": 1, "speed": -1}, {"type": 1}, {"type": 9}, {"type": 0, "is_on": 1}, 5, {"type": 1, "speed": 2}])"));
+        ASSERT_EQ(parser.get_tasks().size(), 1);
+        ASSERT_EQ(get_speed(parser.get_tasks()[0]), 2);
+
+        const auto& errors = parser.get_errors();
+        ASSERT_EQ(errors.size(), 5);
+        ASSERT_STREQ(errors[0].reason, "field is out of range");
+        ASSERT_EQ(errors[0].field, "speed");
+        ASSERT_STREQ(errors[1].reason, "missing field");
+        ASSERT_STREQ(errors[2].reason, "unknown task type");
+        ASSERT_STREQ(errors[3].reason, "field has the wrong type");
+        ASSERT_EQ(errors[3].field, "is_on");
+        ASSERT_STREQ(errors[4].reason, "task must be an object");
+        ASSERT_EQ(errors[4].index, 4);
+    }
+
+    TEST(TaskListParser, RejectsOutOfRangeSpeed) {
+        TaskListParser parser;
+
+        ASSERT_TRUE(parser.parse(R"([{"type": 1, "speed": 1000000}, {"type": 1, "speed": 33}, {"type": 1, "speed": 32}])"));
+        ASSERT_EQ(parser.get_tasks().size(), 1);
+        ASSERT_EQ(get_speed(parser.get_tasks()[0]), dto::MAX_SPEED);
+
+        const auto& errors = parser.get_errors();
+        ASSERT_EQ(errors.size(), 2);
+        for (const auto& error: errors) {
+            ASSERT_STREQ(error.reason, "field is out of range");
+            ASSERT_EQ(error.field, "speed");
+        }
+    }
+
+    TEST(TaskListParser, RejectsMalformedDocument) {
+        TaskListParser parser;
+
+        ASSERT_FALSE(parser.parse(R"([{"type": 1, "speed": )"));
+        ASSERT_FALSE(parser.get_parse_error().empty());
+
+        // The next document starts from a clean slate
+        ASSERT_TRUE(parser.parse("[]"));
+        ASSERT_TRUE(parser.get_parse_error().empty());
+        ASSERT_TRUE(parser.get_tasks().empty());
+    }
+
+    TEST(TaskListParser, ParsesEveryWireFormat) {
+        TaskListParser parser;
+        std::string buffer;
+
+        for (const auto format: {WireFormat::JSON, WireFormat::CBOR, WireFormat::MSGPACK}) {
+            const auto document = encode_document(format, buffer, [](auto& writer) {
+                writer.begin_object();
+                writer.key("tasks").begin_array();
+                writer.begin_object().field("type", dto::TaskType::POWER).field("is_on", true).end_object();
+                writer.begin_object().field("type", dto::TaskType::SPEED).field("speed", 7).end_object();
+                writer.begin_object().field("type", dto::TaskType::MODE).field("mode", dto::Mode::DEFAULT).end_object();
+                writer.end_array();
+                writer.end_object();
+            });
+
+            ASSERT_TRUE(parser.parse(document, format)) << get_wire_format_name(format);
+            ASSERT_TRUE(parser.get_errors().empty()) << get_wire_format_name(format);
+            ASSERT_EQ(parser.get_tasks().size(), 3) << get_wire_format_name(format);
+            ASSERT_EQ(get_speed(parser.get_tasks()[1]), 7) << get_wire_format_name(format);
+        }
+    }
+
+    TEST(TaskReducer, KeepsOnlyFinalSpeed) {
+        const std::vector<dto::Task> tasks{dto::PowerTask{true}, dto::SpeedTask{6}, dto::SpeedTask{9}, dto::SpeedTask{3}};
+        std::vector<dto::Task> reduced;
+
+        reduce_tasks(OFF_STATE, tasks, reduced);
+
+        ASSERT_EQ(reduced.size(), 1);
+        ASSERT_EQ(get_speed(reduced[0]), 3);
+    }
+
+    TEST(TaskReducer, DropsTasksWithoutNetChange) {
+        const TaskState initial{true, 3, dto::Mode::DEFAULT};
+        const std::vector<dto::Task> tasks{dto::SpeedTask{5}, dto::SpeedTask{3}};
+        std::vector<dto::Task> reduced{dto::PowerTask{false}};
+
+        reduce_tasks(initial, tasks, reduced);
+        ASSERT_TRUE(reduced.empty());
+
+        reduce_tasks(OFF_STATE, std::vector<dto::Task>{dto::SpeedTask{4}, dto::SpeedTask{0}}, reduced);
+        ASSERT_TRUE(reduced.empty());
+    }
+
+    TEST(TaskReducer, PowersOffOnce) {
+        const TaskState initial{true, 4, dto::Mode::DEFAULT};
+        const std::vector<dto::Task> tasks{dto::SpeedTask{2}, dto::PowerTask{false}};
+        std::vector<dto::Task> reduced;
+
+        reduce_tasks(initial, tasks, reduced);
+
+        ASSERT_EQ(reduced.size(), 1);
+        ASSERT_FALSE(std::get<dto::PowerTask>(reduced[0]).is_on);
+    }
+
+    TEST(TaskReducer, RestartsAtLowestSpeedAfterPowerCycle) {
+        const TaskState initial{true, 2, dto::Mode::DEFAULT};
+        const std::vector<dto::Task> tasks{dto::PowerTask{false}, dto::PowerTask{true}};
+        std::vector<dto::Task> reduced;
+
+        reduce_tasks(initial, tasks, reduced);
+
+        ASSERT_EQ(reduced.size(), 1);
+        ASSERT_EQ(get_speed(reduced[0]), 1);
+    }
+}